@@ -0,0 +1,87 @@
+// Cost of LOGIN for a range of KDF iteration counts (the --auth-cost knob).
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Isrc bench/AuthBench.cpp src/Auth.cpp src/Kdf.cpp src/DurableFile.cpp -o auth_bench
+// Usage: auth_bench [staff accounts] [logins per measurement]
+//
+// For every cost: a shift-change storm (each account logs in once: full KDF),
+// a second round (session cache hits) and wrong passwords (full KDF, no cache).
+// The user table lives in a scratch file that is removed afterwards.
+
+#include "Auth.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+static const char* const SCRATCH_FILE = "auth_bench_users.txt";
+
+// The pre-KDF users_db.txt hash (see AuthSystem::computeHash)
+static unsigned long legacyHash(const std::string& password) {
+    unsigned long hash = HASH_SEED;
+    for (char c : password) hash = ((hash << 5) + hash) + c;
+    return hash;
+}
+
+static double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    int staff = (argc > 1) ? atoi(argv[1]) : 200;
+    int attempts = (argc > 2) ? atoi(argv[2]) : 20;
+    if (attempts > staff) attempts = staff;
+
+    const int COSTS[] = { 1000, 5000, 20000, 50000, 100000, 300000 };
+    const int COST_COUNT = sizeof(COSTS) / sizeof(COSTS[0]);
+
+    printf("%d accounts, %d logins per column (ms per login; storm = every account once)\n\n", staff, attempts);
+    printf("%10s %12s %12s %12s %14s\n", "iterations", "first login", "re-login", "wrong pass", "storm total");
+
+    for (int c = 0; c < COST_COUNT; c++) {
+        // Accounts start as legacy DJB2 lines; the first login of each measured
+        // account upgrades it to this cost, so setup pays one KDF per account
+        remove(SCRATCH_FILE);
+        {
+            std::ofstream file(SCRATCH_FILE);
+            for (int i = 0; i < staff; i++) {
+                file << "staff" << i << " " << legacyHash("pw" + std::to_string(i)) << "\n";
+            }
+        }
+        {
+            AuthSystem upgrade(SCRATCH_FILE);
+            upgrade.setCost(COSTS[c]);
+            for (int i = 0; i < attempts; i++) {
+                upgrade.login("staff" + std::to_string(i), "pw" + std::to_string(i));
+            }
+        }
+
+        // Fresh process view: nothing cached yet
+        AuthSystem storm(SCRATCH_FILE);
+        storm.setCost(COSTS[c]);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < attempts; i++) {
+            storm.login("staff" + std::to_string(i), "pw" + std::to_string(i));
+        }
+        double first = millisSince(start) / attempts;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < attempts; i++) {
+            storm.login("staff" + std::to_string(i), "pw" + std::to_string(i));
+        }
+        double again = millisSince(start) / attempts;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < attempts; i++) {
+            storm.login("staff" + std::to_string(i), "wrong");
+        }
+        double wrong = millisSince(start) / attempts;
+
+        printf("%10d %12.3f %12.4f %12.3f %12.0f ms\n", COSTS[c], first, again, wrong, first * staff);
+    }
+
+    remove(SCRATCH_FILE);
+    remove((std::string(SCRATCH_FILE) + ".tmp").c_str());
+    return 0;
+}
@@ -0,0 +1,242 @@
+// Cost per operation of the queue engines, 100 to 1M waiting patients.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Isrc bench/QueueBench.cpp src/TriageQueue.cpp src/FibonacciQueue.cpp
+//       src/BucketQueue.cpp src/PriorityKey.cpp -o queue_bench
+// Usage: queue_bench [largest size]
+//
+// Engines: fib, fib-age, bucket, and "std-heap": std::priority_queue plus an
+// ID map, the usual binary-heap design (lazy deletion for UPDATE and LEAVE,
+// MERGE re-inserts every patient). Per size and engine:
+//   insert       n ADDs into an empty queue
+//   consolidate  the first EXTRACT after those ADDs (the Fibonacci heap pays
+//                for the whole batch of roots here, through consolidateWide()
+//                and the key kernel printed first)
+//   update       re-triage of up to 100k random patients
+//   remove       walkouts of up to 100k patients
+//   extract      draining what is left
+//   merge        folding a queue of n/2 patients into another of n/2
+
+#include "TriageQueue.h"
+#include "SimdKeys.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <string>
+#include <unordered_map>
+
+// Small xorshift generator (same as the other benchmarks)
+static unsigned long long nextRandom(unsigned long long& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static double nowNanos() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ==========================================
+// BINARY HEAP BASELINE
+// ==========================================
+
+// What a std::priority_queue design needs to offer the same commands
+class StdHeapQueue {
+private:
+    struct Entry {
+        PriorityKey key;
+        long long id;
+        bool operator<(const Entry& other) const { return key > other.key; } // Min-heap
+    };
+    struct Record {
+        PriorityKey key;    // Current key; heap entries with another key are stale
+        int priority;
+        int age;
+        std::string name;
+        std::string description;
+    };
+
+    std::priority_queue<Entry> heap;
+    std::unordered_map<long long, Record> records;
+    Record last;            // Extracted patient, like the engines' retired record
+
+    // Drops stale entries (updated or removed patients) from the top
+    void skipStale() {
+        while (!heap.empty()) {
+            std::unordered_map<long long, Record>::iterator it = records.find(heap.top().id);
+            if (it != records.end() && it->second.key == heap.top().key) return;
+            heap.pop();
+        }
+    }
+
+public:
+    static StdHeapQueue* create(const std::string&) { return new StdHeapQueue(); }
+    StdHeapQueue* createEmpty() { return new StdHeapQueue(); }
+
+    bool insert(long long id, int priority, int age, std::string name, std::string desc) {
+        PriorityKey key = EsiArrivalKey::pack(priority, age, arrivalClock());
+        Record rec = { key, priority, age, name, desc };
+        if (!records.emplace(id, rec).second) return false;
+        Entry e = { key, id };
+        heap.push(e);
+        return true;
+    }
+
+    bool extractMin(TriageEntry& out) {
+        skipStale();
+        if (heap.empty()) return false;
+
+        std::unordered_map<long long, Record>::iterator it = records.find(heap.top().id);
+        last = it->second;
+        out.id = it->first;
+        out.priority = last.priority;
+        out.arrival = EsiArrivalKey::arrival(last.key);
+        out.record = nullptr;
+        records.erase(it);
+        heap.pop();
+        return true;
+    }
+
+    bool updatePriority(long long id, int newPriority) {
+        std::unordered_map<long long, Record>::iterator it = records.find(id);
+        if (it == records.end()) return false;
+        it->second.key = EsiArrivalKey::withLevel(it->second.key, newPriority);
+        it->second.priority = newPriority;
+        Entry e = { it->second.key, id };
+        heap.push(e);
+        return true;
+    }
+
+    bool removePatient(long long id) {
+        return records.erase(id) > 0;
+    }
+
+    bool merge(StdHeapQueue& other, long long& collidingId) {
+        for (std::unordered_map<long long, Record>::iterator it = other.records.begin();
+             it != other.records.end(); ++it) {
+            if (records.count(it->first)) {
+                collidingId = it->first;
+                return false;
+            }
+        }
+        for (std::unordered_map<long long, Record>::iterator it = other.records.begin();
+             it != other.records.end(); ++it) {
+            records.emplace(it->first, it->second);
+            Entry e = { it->second.key, it->first };
+            heap.push(e);
+        }
+        other.records.clear();
+        other.heap = std::priority_queue<Entry>();
+        return true;
+    }
+};
+
+// ==========================================
+// SCENARIO
+// ==========================================
+
+struct Timings {
+    double insert, consolidate, update, remove, extract, merge; // Nanoseconds
+    long long inserts, updates, removes, extracts, merges;
+};
+
+template <typename Queue>
+static void measure(const std::string& engine, int n, Timings& t) {
+    // Small sizes are repeated so every figure covers enough work to time
+    int reps = (n >= 200000) ? 1 : 200000 / n;
+    int changes = (n / 2 < 100000) ? n / 2 : 100000;
+    unsigned long long rng = 0x9e3779b97f4a7c15ULL + n;
+    TriageEntry out;
+    long long collidingId;
+
+    t.insert = t.consolidate = t.update = t.remove = t.extract = t.merge = 0;
+    t.inserts = t.updates = t.removes = t.extracts = t.merges = 0;
+
+    for (int r = 0; r < reps; r++) {
+        Queue* queue = Queue::create(engine);
+
+        // 1. ADD n patients
+        double start = nowNanos();
+        for (int i = 1; i <= n; i++) {
+            queue->insert(i, (int)(nextRandom(rng) % 10) + 1, 40, "Bench", "load");
+        }
+        t.insert += nowNanos() - start;
+        t.inserts += n;
+
+        // 2. First EXTRACT: consolidation of all the new roots
+        start = nowNanos();
+        queue->extractMin(out);
+        t.consolidate += nowNanos() - start;
+
+        // 3. Re-triage random patients (odd IDs), then walkouts (even IDs)
+        start = nowNanos();
+        for (int i = 0; i < changes; i++) {
+            long long id = (long long)(nextRandom(rng) % (unsigned long long)(n / 2)) * 2 + 1;
+            queue->updatePriority(id, (int)(nextRandom(rng) % 10) + 1);
+        }
+        t.update += nowNanos() - start;
+        t.updates += changes;
+
+        start = nowNanos();
+        for (int i = 1; i <= changes; i++) {
+            queue->removePatient((long long)i * 2);
+        }
+        t.remove += nowNanos() - start;
+        t.removes += changes;
+
+        // 4. Treat everyone else
+        start = nowNanos();
+        while (queue->extractMin(out)) t.extracts++;
+        t.extract += nowNanos() - start;
+        delete queue;
+
+        // 5. MERGE two halves
+        Queue* a = Queue::create(engine);
+        Queue* b = a->createEmpty();
+        for (int i = 1; i <= n; i++) {
+            Queue* target = (i % 2 == 0) ? a : b;
+            target->insert(i, (int)(nextRandom(rng) % 10) + 1, 40, "Bench", "load");
+        }
+        start = nowNanos();
+        a->merge(*b, collidingId);
+        t.merge += nowNanos() - start;
+        t.merges++;
+        delete b;
+        delete a;
+    }
+
+    t.consolidate /= reps;
+    t.merge /= t.merges;
+}
+
+static void printRow(int n, const char* engine, const Timings& t) {
+    printf("%8d %-9s %9.1f %9.1f %9.1f %9.1f %12.1f %12.1f\n", n, engine,
+           t.insert / t.inserts, t.extract / (t.extracts > 0 ? t.extracts : 1),
+           t.update / t.updates, t.remove / t.removes,
+           t.consolidate / 1000.0, t.merge / 1000.0);
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    int largest = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+    const char* engines[] = {"fib", "fib-age", "bucket"};
+    printf("Wide consolidate kernel: %s\n\n", simdkeys::kernelName());
+    printf("%8s %-9s %9s %9s %9s %9s %12s %12s\n", "size", "engine", "insert", "extract",
+           "update", "remove", "consol.(us)", "merge(us)");
+    printf("%8s %-9s %39s\n", "", "", "(ns per operation)");
+
+    for (int n = 100; n <= largest; n *= 10) {
+        Timings t;
+        for (int e = 0; e < 3; e++) {
+            measure<TriageQueue>(engines[e], n, t);
+            printRow(n, engines[e], t);
+        }
+        measure<StdHeapQueue>("std-heap", n, t);
+        printRow(n, "std-heap", t);
+    }
+    return 0;
+}
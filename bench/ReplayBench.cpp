@@ -0,0 +1,372 @@
+// Replays a command trace through System::run() and reports throughput and
+// reply latency, exactly as the GUI would see them on its pipe.
+//
+// Build (from the repository root; every source file except main.cpp):
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/ReplayBench.cpp $(ls src/*.cpp | grep -v main.cpp)
+//       -o replay_bench
+// Usage: replay_bench [--engine=fib|fib-age|bucket] [--pipelined] [--write-trace=FILE]
+//                     (TRACE_FILE | --surge=PATIENTS)
+//
+// A trace is protocol text, one command per line (BEGIN/BATCH blocks allowed),
+// starting with a LOGIN. --surge generates a mass-casualty evening: a calm
+// phase, ambulance loads arriving in BATCH blocks with deteriorating patients
+// and dashboard polls, then recovery. Generated IDs assume an empty queue, so
+// run it in a scratch directory (System loads and saves patients_data.* there).
+//
+// Default (closed loop): one request at a time, like the bridge; latency is
+// measured per request, from handing it to stdin to its last reply line.
+// --pipelined: the whole trace is written at once; throughput only.
+
+#include "System.h"
+#include "Server.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+static long long nowMicros() {
+    return (long long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ==========================================
+// STDIN / STDOUT REPLACEMENTS
+// ==========================================
+
+// std::cin for the backend: blocks the reader thread until the driver pushes text
+class TraceInput : public std::streambuf {
+private:
+    std::mutex lock;
+    std::condition_variable ready;
+    std::string pending;    // Pushed, not yet handed to the reader
+    std::string current;    // Being read (the get area)
+    bool closed;
+
+protected:
+    int_type underflow() {
+        std::unique_lock<std::mutex> guard(lock);
+        ready.wait(guard, [this] { return !pending.empty() || closed; });
+        if (pending.empty()) return traits_type::eof();
+
+        current.swap(pending);
+        pending.clear();
+        setg(&current[0], &current[0], &current[0] + current.size());
+        return traits_type::to_int_type(current[0]);
+    }
+
+public:
+    TraceInput() : closed(false) {}
+
+    void push(const std::string& text) {
+        std::lock_guard<std::mutex> guard(lock);
+        pending += text;
+        ready.notify_one();
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> guard(lock);
+        closed = true;
+        ready.notify_one();
+    }
+};
+
+// std::cout for the backend: collects the writer thread's output as lines
+class ReplyOutput : public std::streambuf {
+private:
+    std::mutex lock;
+    std::condition_variable ready;
+    std::string partial;    // Writer side: text after the last newline
+    std::string lines;      // Complete lines not yet taken by the driver
+    std::string taken;      // Driver side
+    size_t takenPos;
+
+protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) {
+        partial.append(s, (size_t)n);
+        size_t end = partial.rfind('\n');
+        if (end != std::string::npos) {
+            std::lock_guard<std::mutex> guard(lock);
+            lines.append(partial, 0, end + 1);
+            ready.notify_one();
+            partial.erase(0, end + 1);
+        }
+        return n;
+    }
+
+    int_type overflow(int_type c) {
+        if (c != traits_type::eof()) {
+            char ch = traits_type::to_char_type(c);
+            xsputn(&ch, 1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+public:
+    ReplyOutput() : takenPos(0) {}
+
+    // Next reply line (without the newline); waits for the backend
+    void nextLine(std::string& line) {
+        while (true) {
+            size_t end = taken.find('\n', takenPos);
+            if (end != std::string::npos) {
+                line.assign(taken, takenPos, end - takenPos);
+                takenPos = end + 1;
+                return;
+            }
+            taken.erase(0, takenPos);
+            takenPos = 0;
+
+            std::unique_lock<std::mutex> guard(lock);
+            ready.wait(guard, [this] { return !lines.empty(); });
+            taken += lines;
+            lines.clear();
+        }
+    }
+};
+
+// ==========================================
+// TRACES
+// ==========================================
+
+static std::string firstWord(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) return "";
+    size_t end = text.find_first_of(" \t\r\n", start);
+    return text.substr(start, end - start);
+}
+
+// True if 'line' is the last reply line of a request starting with 'command'
+static bool endsReply(const std::string& command, const std::string& line) {
+    std::string word = firstWord(line);
+    if (word.compare(0, 5, "ERROR") == 0) return true; // ERROR:, ERROR_AUTH, ...
+
+    if (command == "BEGIN" || command == "BATCH") return word == "BATCH_END";
+    if (command == "TOPK") return word == "TOPK_END";
+    if (command == "RANGE") return word == "RANGE_END";
+    if (command == "UPDATE") return word == "SUCCESS_UPDATE";   // After "Error: ... not found"
+    if (command == "LEAVE_MANY") return word == "SUCCESS_REMOVE_MANY";
+    if (command == "SUBSCRIBE") return word == "SUBSCRIBED";
+    if (command == "CHANGES") return word == "CHANGES_END" || word == "CHANGES_RESET";
+    if (command == "METRICS") return line == "# EOF";
+    if (command == "SNAPSHOT") return word == "SNAPSHOT_END";
+    if (command == "AUDIT") return word == "AUDIT_END";
+    if (command == "QUEUES") return word == "QUEUES_END";
+    return true;    // One reply line
+}
+
+// Splits a trace into requests (a line or a whole BEGIN/BATCH block).
+// LIST has no end marker, so it is replayed as "BEGIN LIST END".
+static int splitTrace(const std::string& trace, std::string*& units) {
+    int count = 0, capacity = 1024;
+    units = new std::string[capacity];
+
+    size_t pos = 0, length;
+    while ((length = SocketServer::unitLength(trace, pos)) > 0) {
+        std::string unit = trace.substr(pos, length);
+        pos += length;
+
+        std::string command = firstWord(unit);
+        if (command.empty()) continue;
+        if (command == "LIST") unit = "BEGIN\n" + unit + "END\n";
+
+        if (count == capacity) {
+            std::string* bigger = new std::string[capacity * 2];
+            for (int i = 0; i < count; i++) bigger[i].swap(units[i]);
+            delete[] units;
+            units = bigger;
+            capacity *= 2;
+        }
+        units[count++].swap(unit);
+    }
+    return count;
+}
+
+// Small xorshift generator (same as the other benchmarks)
+static unsigned long long nextRandom(unsigned long long& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static std::string surgeTrace(int patients) {
+    const char* complaints[] = {"chest_pain", "fracture", "burns", "dyspnea", "laceration", "head_injury"};
+    unsigned long long rng = 0x2545f4914f6cdd1dULL;
+    std::ostringstream out;
+    int added = 0;
+    int commands = 0;
+
+    out << "LOGIN admin admin\n";
+
+    // 1. Calm evening: walk-ins, steady treatment, dashboard polling
+    for (int i = 0; i < patients / 5; i++) {
+        out << "ADD " << 3 + (int)(nextRandom(rng) % 3) << " " << 18 + (int)(nextRandom(rng) % 70)
+            << " Walkin" << ++added << " " << complaints[nextRandom(rng) % 6] << "\n";
+        if (i % 2 == 1) out << "EXTRACT\n";
+        if (++commands % 25 == 0) out << "STATS\n";
+        if (commands % 50 == 0) out << "PING\n";
+    }
+
+    // 2. Mass casualty: ambulance loads of ten, deteriorations, the critical board
+    for (int i = 0; i < patients * 3 / 5; i += 10) {
+        out << "BATCH 10\n";
+        for (int j = 0; j < 10; j++) {
+            out << "ADD " << 1 + (int)(nextRandom(rng) % 3) << " " << (int)(nextRandom(rng) % 90)
+                << " Victim" << ++added << " " << complaints[nextRandom(rng) % 6] << "\n";
+        }
+        out << "UPDATE " << 1 + (long long)(nextRandom(rng) % added) << " 1\n";
+        out << "TOPK 10\n";
+        out << "RANGE 1 2\n";
+        out << "EXTRACT\nEXTRACT\n";
+        out << "STATS\n";
+    }
+
+    // 3. Recovery: fewer arrivals, faster treatment, some walkouts
+    for (int i = 0; i < patients / 5; i++) {
+        out << "ADD " << 4 + (int)(nextRandom(rng) % 2) << " " << 18 + (int)(nextRandom(rng) % 70)
+            << " Walkin" << ++added << " " << complaints[nextRandom(rng) % 6] << "\n";
+        out << "EXTRACT\nEXTRACT\n";
+        if (i % 10 == 0) out << "LEAVE " << 1 + (long long)(nextRandom(rng) % added) << "\n";
+        if (i % 20 == 0) out << "STATS\n";
+    }
+    return out.str();
+}
+
+// ==========================================
+// REPORT
+// ==========================================
+
+// Latency percentiles of 'count' samples (sorted in place), in microseconds
+static void printLatency(const char* label, long long* samples, int count) {
+    if (count == 0) return;
+    std::sort(samples, samples + count);
+    printf("%-10s %8d %9lld %9lld %9lld %9lld %9lld\n", label, count,
+           samples[(count - 1) * 50 / 100], samples[(count - 1) * 90 / 100],
+           samples[(count - 1) * 99 / 100], samples[(int)((count - 1) * 999LL / 1000)],
+           samples[count - 1]);
+}
+
+int main(int argc, char* argv[]) {
+    std::string engine = "fib";
+    std::string traceFile, writeTrace;
+    int surge = 0;
+    bool pipelined = false;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--engine=", 9) == 0) engine = argv[i] + 9;
+        else if (strncmp(argv[i], "--surge=", 8) == 0) surge = atoi(argv[i] + 8);
+        else if (strncmp(argv[i], "--write-trace=", 14) == 0) writeTrace = argv[i] + 14;
+        else if (strcmp(argv[i], "--pipelined") == 0) pipelined = true;
+        else traceFile = argv[i];
+    }
+
+    // 1. Load or generate the trace
+    std::string trace;
+    if (surge > 0) {
+        trace = surgeTrace(surge);
+    } else if (!traceFile.empty()) {
+        std::ifstream file(traceFile, std::ios::binary);
+        if (!file.is_open()) {
+            fprintf(stderr, "Cannot open %s\n", traceFile.c_str());
+            return 1;
+        }
+        std::ostringstream text;
+        text << file.rdbuf();
+        trace = text.str();
+        if (!trace.empty() && trace[trace.size() - 1] != '\n') trace += "\n";
+    } else {
+        fprintf(stderr, "Usage: replay_bench [--engine=E] [--pipelined] [--write-trace=FILE] (TRACE | --surge=N)\n");
+        return 1;
+    }
+    if (!writeTrace.empty()) {
+        std::ofstream file(writeTrace, std::ios::binary);
+        file << trace;
+    }
+
+    std::string* units;
+    int count = splitTrace(trace, units);
+
+    // 2. Start the backend on the replacement streams
+    TraceInput input;
+    ReplyOutput output;
+    std::streambuf* oldIn = std::cin.rdbuf(&input);
+    std::streambuf* oldOut = std::cout.rdbuf(&output);
+
+    System* app = new System(engine);
+    std::thread backend([app] { app->run(); });
+
+    // 3. Replay
+    long long* latency = new long long[count];
+    std::string line;
+    long long start = nowMicros();
+
+    if (pipelined) {
+        // Everything at once; POOL goes through the owner thread after every
+        // other command, so its reply marks the end of the trace
+        std::string all;
+        int pools = 1;
+        for (int i = 0; i < count; i++) {
+            all += units[i];
+            if (firstWord(units[i]) == "POOL") pools++;
+        }
+        all += "POOL\n";
+        input.push(all);
+        while (pools > 0) {
+            output.nextLine(line);
+            if (firstWord(line) == "POOL") pools--;
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            std::string command = firstWord(units[i]);
+            long long sent = nowMicros();
+            input.push(units[i]);
+            do {
+                output.nextLine(line);
+            } while (!endsReply(command, line));
+            latency[i] = nowMicros() - sent;
+        }
+    }
+    long long elapsed = nowMicros() - start;
+
+    // 4. Shut the backend down (EXIT also writes the final snapshot)
+    input.push("EXIT\n");
+    do {
+        output.nextLine(line);
+    } while (firstWord(line) != "SUCCESS_EXIT");
+    input.close();
+    backend.join();
+    delete app;
+    std::cin.rdbuf(oldIn);
+    std::cout.rdbuf(oldOut);
+
+    printf("engine=%s requests=%d mode=%s\n", engine.c_str(), count, pipelined ? "pipelined" : "closed-loop");
+    printf("elapsed %.3f s, %.0f requests/s\n", elapsed / 1e6, count / (elapsed / 1e6));
+
+    if (!pipelined) {
+        // Overall, then per command (a BATCH block counts as one request)
+        printf("%-10s %8s %9s %9s %9s %9s %9s\n", "request", "count", "p50(us)", "p90", "p99", "p99.9", "max");
+        long long* samples = new long long[count];
+        for (int i = 0; i < count; i++) samples[i] = latency[i];
+        printLatency("all", samples, count);
+
+        const char* kinds[] = {"ADD", "BATCH", "EXTRACT", "UPDATE", "LEAVE", "TOPK", "RANGE", "STATS", "PING"};
+        for (int k = 0; k < 9; k++) {
+            int n = 0;
+            for (int i = 0; i < count; i++) {
+                if (firstWord(units[i]) == kinds[k]) samples[n++] = latency[i];
+            }
+            printLatency(kinds[k], samples, n);
+        }
+        delete[] samples;
+    }
+
+    delete[] latency;
+    delete[] units;
+    return 0;
+}
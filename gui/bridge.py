@@ -10,23 +10,94 @@ Commands Protocol:
         LOGIN <username> <password>     -> SUCCESS_LOGIN | ERROR_LOGIN
         CHANGE_PASS <user> <old> <new>  -> SUCCESS_PASS_CHANGE | ERROR_PASS_CHANGE
         EXIT                            -> SUCCESS_EXIT
-        PING                            -> PONG
+        PING                            -> PONG  (answered by the reader thread when no earlier command is
+                                                  pending; replies always come back in request order)
     
     AUTHENTICATED:
-        ADD <priority> <age> <name> <desc>  -> SUCCESS_ADD <name> ID:<id>
+        ADD <priority> <age> <name> <desc>  -> SUCCESS_ADD <name> ID:<id> | ERROR: Priority must be 1-10
+                                                | ERROR: Name and description must be at most 65535 bytes
         EXTRACT                              -> DATA <id> <prio> <age> <name> <desc> | EMPTY
         PEEK                                 -> DATA <id> <prio> <age> <name> <desc> | EMPTY
-        STATS                                -> STATS COUNT:<n> WAIT:<mins>
-        UPDATE <id> <new_priority>           -> SUCCESS_UPDATE
-        LEAVE <id>                           -> SUCCESS_REMOVE <id>
+        STATS                                -> STATS COUNT:<n> WAIT:<median mins> TREATED:<n>
+                                                [ESI<k>:<p50>/<p90>/<p99> ...]  (observed waits, -1 = no data)
+                                                Outside BEGIN/BATCH, with no earlier command pending, it is
+                                                answered by the reader thread from the last published view.
+        POOL                                 -> POOL LIVE:<n> PEAK:<n> CAPACITY:<n> SLABS:<n>
+        METRICS                              -> Prometheus text: per-command latency histograms,
+                                                queue gauges, heap shape (fib engines), then "# EOF"
+        UPDATE <id> <new_priority>           -> SUCCESS_UPDATE | ERROR: Priority must be 1-10
+                                                | ERROR: Invalid patient ID | Error: Patient ID <id> not found.
+        LEAVE <id>                           -> SUCCESS_REMOVE <id> | ERROR: Invalid patient ID
+        LEAVE_MANY <n> <id 1> ... <id n>     -> SUCCESS_REMOVE <id> (per patient found), SUCCESS_REMOVE_MANY <n>
+                                                | ERROR: ... (n above 100000, or fewer than n IDs)
         MERGE <filename>                     -> SUCCESS_MERGE | ERROR_FILE_NOT_FOUND
+                                                | ERROR_MERGE_COLLISION <id>
+        EXPORT <filename>                    -> SUCCESS_EXPORT | ERROR_FILE_NOT_FOUND  (text format)
+        UNDO | REDO                          -> SUCCESS_UNDO|SUCCESS_REDO <command> <patients>
+                                                | ERROR_NOTHING_TO_UNDO|REDO | ERROR_UNDO_CONFLICT <id>
+                                                (last 64 ADD/EXTRACT/UPDATE/LEAVE/LEAVE_MANY/MERGE and
+                                                department commands; patients come back with their ID,
+                                                department and place in line)
+        AUDIT <unix seconds | HH:MM>         -> AUDIT <taken at> <n>, AUDIT_DATA <id> <prio> <age> <name> <desc>
+                                                (queue as of the latest image at or before that time,
+                                                images at most a minute apart for a day), then AUDIT_END <n>
+                                                | ERROR_AUDIT_TOO_OLD. Fast path like STATS.
+        QUEUES                               -> QUEUE <name> <waiting> per department ("main" first), then QUEUES_END <n>
+        ADD_TO <queue> <prio> <age> <name> <desc>
+                                             -> SUCCESS_ADD <name> ID:<id> | ERROR_UNKNOWN_QUEUE <queue>
+        EXTRACT_FROM <queue>                 -> DATA <id> <prio> <age> <name> <desc> <queue> | EMPTY
+                                                | ERROR_UNKNOWN_QUEUE <queue>
+        EXTRACT_ANY                          -> DATA ... <queue> (most urgent head of any department) | EMPTY
+        TRANSFER <id> <queue>                -> SUCCESS_TRANSFER <id> <queue> | ERROR_UNKNOWN_QUEUE <queue>
+                                                | ERROR_NOT_QUEUED <id> | ERROR: Invalid patient ID
+                                                (same ID, arrival and wait clock)
+                                                EXTRACT and PEEK serve the "main" queue; LIST, TOPK, RANGE and
+                                                STATS cover every department (--queues=trauma,peds,...)
+        LIST                                 -> LIST_DATA <id> <prio> <age> <name> <desc> (one per patient, EXTRACT order)
+        SNAPSHOT                             -> SNAPSHOT <version> <count>, the STATS line, <count> LIST_DATA
+                                                lines (EXTRACT order), then SNAPSHOT_END <version>
+                                                (a full resync in one reply; CHANGES continues from <version>)
+        TOPK <k>                             -> TOP_DATA <id> <prio> <age> <name> <desc> (next k, EXTRACT order),
+                                                then TOPK_END <n> | ERROR: K must be positive
+        RANGE <lo> <hi>                      -> TOP_DATA ... (every patient with lo <= prio <= hi, EXTRACT order),
+                                                then RANGE_END <n> | ERROR: Range must be within 1-10
+
+    INCREMENTAL SYNC (AUTHENTICATED):
+        SUBSCRIBE                            -> LIST_DATA ... (full queue), then SUBSCRIBED <version>
+        CHANGES <since_version>              -> CHANGE <ver> ADD <id> <prio> <age> <name> <desc>
+                                                CHANGE <ver> UPDATE <id> <prio>
+                                                CHANGE <ver> ESCALATE <id> <prio>   (waited too long)
+                                                CHANGE <ver> REMOVE <id>
+                                                ... then CHANGES_END <version>
+                                              | CHANGES_RESET <version>  (too far behind: SUBSCRIBE again)
+
+    BATCHING (any commands inside, one buffered reply):
+        BEGIN <cmd> ... END                  -> replies of every command, then BATCH_END <n>
+        BATCH <n> <cmd 1> ... <cmd n>        -> replies of every command, then BATCH_END <n>
+
+    DURABILITY:
+        ERROR_LOG_WRITE                      -> appended to a reply when the changes it reports were
+                                                applied but could not be written to disk (disk full?);
+                                                the backend retries on the next command
+
+Coalesced refreshes (SystemBridge(..., coalesce_refresh=True)):
+    refresh(), request_changes() and request_snapshot() keep at most one
+    refresh in flight. Requests made meanwhile fold into a single follow-up,
+    sent when the reply ends (CHANGES_END / CHANGES_RESET / SNAPSHOT_END), so
+    a burst of UI actions costs one extra round-trip, not one dump each.
+
+Server mode (triage --listen=<port> | <host>:<port> | unix:<path>):
+    The same protocol over a socket, one login per connection; requests may be
+    pipelined. EXIT closes the connection only. See RemoteBridge below.
 """
 
+import socket
 import subprocess
 import threading
 import sys
 import os
-from typing import Optional
+import time
+from typing import Optional, List
 
 
 class SystemBridge:
@@ -35,24 +106,46 @@ class SystemBridge:
     Handles launching, communication, and crash recovery.
     
     Usage:
-        bridge = SystemBridge("path/to/triage.exe")
+        bridge = SystemBridge("path/to/triage.exe", coalesce_refresh=True)
         if bridge.start():
             bridge.send_command("LOGIN admin admin")
             response = bridge.read_line()
         bridge.close()
     """
     
-    def __init__(self, exe_path: str):
+    # Refresh kinds, cheapest first; a queued follow-up keeps the biggest one asked for
+    REFRESH_CHANGES = 1     # CHANGES <version>
+    REFRESH_DELTA = 2       # BEGIN STATS, CHANGES <version> END
+    REFRESH_FULL = 3        # SNAPSHOT
+    
+    # Last reply line of each refresh kind
+    REFRESH_END = ("CHANGES_END", "CHANGES_RESET", "SNAPSHOT_END")
+    
+    # A refresh unanswered for this long (backend restarted, ERROR_AUTH...) no longer blocks new ones
+    REFRESH_TIMEOUT = 5.0
+    
+    def __init__(self, exe_path: str, coalesce_refresh: bool = False):
         """
         Initialize the bridge with the path to the C++ executable.
         
         Args:
             exe_path: Path to the triage.exe executable
+            coalesce_refresh: Keep at most one refresh in flight (see module docstring)
         """
         self.exe_path = exe_path
         self.process: Optional[subprocess.Popen] = None
         self.is_running = False
         self.lock = threading.Lock()
+        
+        # Last change-feed version the GUI has applied (see SUBSCRIBE/CHANGES)
+        self.feed_version = 0
+        
+        # Coalescing state: when the refresh in flight was sent (None = idle)
+        # and the refresh kind to send once it is answered (0 = none)
+        self.coalesce_refresh = coalesce_refresh
+        self.refresh_lock = threading.Lock()
+        self.refresh_sent_at: Optional[float] = None
+        self.refresh_pending = 0
     
     def start(self) -> bool:
         """
@@ -86,6 +179,7 @@ class SystemBridge:
             )
             
             self.is_running = True
+            self._reset_refresh()
             print(f"[Bridge] C++ backend started (PID: {self.process.pid})")
             return True
             
@@ -134,6 +228,102 @@ class SystemBridge:
                 print(f"[Bridge] ERROR: Failed to send command: {e}")
                 return False
     
+    def send_batch(self, cmds: List[str]) -> bool:
+        """
+        Sends several commands as one BEGIN ... END block.
+        The backend runs them in order and answers with a single write,
+        so e.g. a STATS + CHANGES refresh costs one pipe round-trip.
+        
+        Args:
+            cmds: Command strings (without newlines)
+            
+        Returns:
+            True if the block was sent successfully, False otherwise
+        """
+        if not cmds:
+            return True
+        return self.send_command("\n".join(["BEGIN"] + cmds + ["END"]))
+    
+    def changes_command(self) -> str:
+        """Command string asking for the changes since the last applied version."""
+        return f"CHANGES {self.feed_version}"
+    
+    def refresh(self) -> bool:
+        """Standard dashboard refresh (STATS + queue delta) in one batch."""
+        return self._request_refresh(self.REFRESH_DELTA)
+    
+    def subscribe(self) -> bool:
+        """
+        Requests a full baseline of the queue plus the current feed version.
+        The reply ends with 'SUBSCRIBED <version>'; pass it to set_feed_version().
+        """
+        return self.send_command("SUBSCRIBE")
+    
+    def request_changes(self) -> bool:
+        """
+        Asks only for the queue changes since the last applied version.
+        Cheaper than LIST: the reply has one line per change, not per patient.
+        """
+        return self._request_refresh(self.REFRESH_CHANGES)
+    
+    def request_snapshot(self) -> bool:
+        """
+        Full resync in one reply: SNAPSHOT <version> <count>, STATS, LIST_DATA ...,
+        SNAPSHOT_END <version>. Replaces a STATS + SUBSCRIBE (or LIST) pair.
+        """
+        return self._request_refresh(self.REFRESH_FULL)
+    
+    def _send_refresh(self, kind: int) -> bool:
+        if kind == self.REFRESH_FULL:
+            return self.send_command("SNAPSHOT")
+        if kind == self.REFRESH_DELTA:
+            return self.send_batch(["STATS", self.changes_command()])
+        return self.send_command(self.changes_command())
+    
+    def _request_refresh(self, kind: int) -> bool:
+        """Sends a refresh now, or folds it into the follow-up of the one in flight."""
+        if self.coalesce_refresh:
+            with self.refresh_lock:
+                now = time.monotonic()
+                if self.refresh_sent_at is not None and now - self.refresh_sent_at < self.REFRESH_TIMEOUT:
+                    self.refresh_pending = max(self.refresh_pending, kind)
+                    return True
+                self.refresh_sent_at = now
+        return self._send_refresh(kind)
+    
+    def _reset_refresh(self) -> None:
+        with self.refresh_lock:
+            self.refresh_sent_at = None
+            self.refresh_pending = 0
+    
+    def _note_reply(self, line: str) -> None:
+        """
+        Called with every reply line. Keeps feed_version current (so a follow-up
+        CHANGES never asks for changes already received) and, when coalescing,
+        sends the queued follow-up once the refresh in flight has been answered.
+        """
+        parts = line.split()
+        if not parts:
+            return
+        word = parts[0]
+        if word in ("CHANGES_END", "SNAPSHOT_END", "SUBSCRIBED") and len(parts) > 1:
+            self.feed_version = int(parts[1])
+        
+        if not self.coalesce_refresh or word not in self.REFRESH_END:
+            return
+        with self.refresh_lock:
+            kind = self.refresh_pending
+            if word == "CHANGES_RESET":
+                kind = self.REFRESH_FULL  # Too far behind: only a full resync helps
+            self.refresh_pending = 0
+            self.refresh_sent_at = time.monotonic() if kind else None
+        if kind:
+            self._send_refresh(kind)
+    
+    def set_feed_version(self, version: int) -> None:
+        """Records the feed version the GUI is now in sync with."""
+        self.feed_version = version
+    
     def read_line(self) -> Optional[str]:
         """
         Reads a single line from the C++ backend's stdout.
@@ -156,6 +346,7 @@ class SystemBridge:
             result = line.strip()
             if result:
                 print(f"[Bridge] RECV: {result}")
+                self._note_reply(result)
             return result
             
         except Exception as e:
@@ -218,3 +409,102 @@ class SystemBridge:
         """Context manager exit - closes the bridge."""
         self.close()
         return False
+
+
+class RemoteBridge(SystemBridge):
+    """
+    Same interface as SystemBridge, but attaches to a backend that is already
+    running in server mode (triage --listen=...) instead of spawning one.
+    Every connection logs in on its own; EXIT only ends this session.
+    
+    Usage:
+        bridge = RemoteBridge("er-server:5599")    # or "unix:/run/triage.sock"
+        if bridge.start():
+            bridge.send_command("LOGIN admin admin")
+    """
+    
+    def __init__(self, address: str, coalesce_refresh: bool = False):
+        super().__init__(exe_path="", coalesce_refresh=coalesce_refresh)
+        self.address = address
+        self.sock: Optional[socket.socket] = None
+        self.stream = None
+    
+    def start(self) -> bool:
+        """Connects to the backend. Returns True on success."""
+        try:
+            if self.address.startswith("unix:"):
+                self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+                self.sock.connect(self.address[5:])
+            else:
+                host, _, port = self.address.rpartition(":")
+                self.sock = socket.create_connection((host or "127.0.0.1", int(port)))
+                self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            
+            self.stream = self.sock.makefile("rw", encoding="utf-8", newline="\n")
+            self.is_running = True
+            self._reset_refresh()
+            print(f"[Bridge] Connected to backend at {self.address}")
+            return True
+        except Exception as e:
+            print(f"[Bridge] ERROR: Cannot connect to '{self.address}': {e}")
+            self.sock = None
+            return False
+    
+    def send_command(self, cmd: str) -> bool:
+        """Sends a text command over the connection."""
+        with self.lock:
+            if not self.is_running or self.stream is None:
+                print("[Bridge] WARNING: Cannot send - not connected")
+                return False
+            try:
+                self.stream.write(cmd + "\n")
+                self.stream.flush()
+                print(f"[Bridge] SENT: {cmd}")
+                return True
+            except OSError as e:
+                self.is_running = False
+                print(f"[Bridge] ERROR: Connection lost: {e}")
+                return False
+    
+    def read_line(self) -> Optional[str]:
+        """Reads a single reply line (blocking). None once the connection is gone."""
+        if not self.is_running or self.stream is None:
+            return None
+        try:
+            line = self.stream.readline()
+            if line == "":
+                self.is_running = False
+                return None
+            result = line.strip()
+            if result:
+                print(f"[Bridge] RECV: {result}")
+                self._note_reply(result)
+            return result
+        except Exception as e:
+            print(f"[Bridge] ERROR: Failed to read line: {e}")
+            return None
+    
+    def check_alive(self) -> bool:
+        """True while the connection is open (the server keeps running without us)."""
+        return self.is_running
+    
+    def close(self) -> None:
+        """Ends this session; the backend keeps serving other dashboards."""
+        with self.lock:
+            if self.stream is not None:
+                try:
+                    if self.is_running:
+                        self.stream.write("EXIT\n")
+                        self.stream.flush()
+                except Exception:
+                    pass
+                try:
+                    self.stream.close()
+                    self.sock.close()
+                except Exception:
+                    pass
+                print("[Bridge] Disconnected from backend")
+            
+            self.is_running = False
+            self.stream = None
+            self.sock = None
@@ -234,6 +234,9 @@ class DashboardFrame(ctk.CTkFrame):
         self.patient_count = 0
         self.estimated_wait = 0
         self.pending_extract = False
+        # Between SNAPSHOT and SNAPSHOT_END: the cards shown before, by ID (reused, so
+        # vitals and selection survive a resync); the sidebar is redrawn once at the end
+        self.snapshot_previous: Optional[dict] = None
         
         self.sound_engine = SoundEngine()
         self._alarm_playing = False
@@ -246,19 +249,15 @@ class DashboardFrame(ctk.CTkFrame):
         self._start_status_monitor()
         self._start_animation_loop()
         self._start_cpp_listener()
-        self._start_simulation_loop()
+        self._start_aging_poll()
         
         # Use 'after' with safe checks
-        self.after(500, self._safe_send_stats)
-        self.after(600, self._safe_send_list)
+        self.after(500, self._safe_initial_sync)
 
-    def _safe_send_stats(self):
+    def _safe_initial_sync(self):
+        # STATS + full baseline in one reply (one pipe round-trip)
         if self.running and self.winfo_exists():
-            self.bridge.send_command("STATS")
-
-    def _safe_send_list(self):
-        if self.running and self.winfo_exists():
-            self.bridge.send_command("LIST")
+            self.bridge.request_snapshot()
     
     def _create_header(self) -> None:
         header = ctk.CTkFrame(self, fg_color=COLORS["bg_card"], height=70, corner_radius=0)
@@ -756,30 +755,22 @@ class DashboardFrame(ctk.CTkFrame):
                     break
         threading.Thread(target=listen, daemon=True).start()
     
-    def _start_simulation_loop(self) -> None:
-        def simulate():
+    def _start_aging_poll(self) -> None:
+        # The backend escalates patients who waited too long; pick those up
+        # through the change feed (ESCALATE lines) every few seconds.
+        def poll():
             while self.running:
-                try:
-                    wait_time = random.randint(15, 45)
-                    for _ in range(wait_time * 2):
-                        if not self.running: return
-                        time.sleep(0.5)
-                    
+                for _ in range(10):
                     if not self.running: return
-                    
-                    stable_patients = [p for p in self.patients if p.priority > 1]
-                    if stable_patients:
-                        patient = random.choice(stable_patients)
-                        patient.priority = 1
-                        
-                        self.after(0, lambda pid=patient.id: self.bridge.send_command(f"UPDATE {pid} 1"))
-                        self.after(0, lambda name=patient.name: self._show_deterioration_alert(name))
-                        self.after(100, self._refresh_sidebar)
+                    time.sleep(0.5)
+                try:
+                    if not self.winfo_exists(): break
+                    self.after(0, self.bridge.request_changes)
                 except Exception:
-                    if not self.running: return
-        threading.Thread(target=simulate, daemon=True).start()
+                    break
+        threading.Thread(target=poll, daemon=True).start()
     
-    def _show_deterioration_alert(self, patient_name: str) -> None:
+    def _show_deterioration_alert(self, patient_name: str, priority: int) -> None:
         if not self.winfo_exists(): return
         
         # FIX: Use winfo_toplevel()
@@ -807,14 +798,14 @@ class DashboardFrame(ctk.CTkFrame):
         
         ctk.CTkLabel(
             alert,
-            text=f"Patient {patient_name} condition deteriorated!",
+            text=f"Patient {patient_name} escalated!",
             font=ctk.CTkFont(size=16),
             text_color="#ffffff"
         ).pack(pady=5)
         
         ctk.CTkLabel(
             alert,
-            text="Now PRIORITY 1 - Immediate attention required",
+            text=f"Now PRIORITY {priority} - waited past the limit for their level",
             font=ctk.CTkFont(size=12),
             text_color="#ffcccc"
         ).pack(pady=5)
@@ -842,7 +833,7 @@ class DashboardFrame(ctk.CTkFrame):
                     break
             
             self._refresh_sidebar()
-            self.bridge.send_command("STATS")
+            self.bridge.refresh()
             messagebox.showinfo("Patient Added", f"{display_name} added with ID: {pid}")
         
         elif cmd == "DATA":
@@ -866,8 +857,7 @@ class DashboardFrame(ctk.CTkFrame):
                     
                     self._refresh_sidebar()
                     self._update_monitor()
-                    self.bridge.send_command("STATS")
-                    self.bridge.send_command("LIST")
+                    self.bridge.refresh()
                     
                     diagnosis = getattr(self, 'current_diagnosis', '')
                     self._show_treatment_alert(display_name, pid, prio, diagnosis)
@@ -891,7 +881,15 @@ class DashboardFrame(ctk.CTkFrame):
                 elif p.startswith("WAIT:"):
                     self.estimated_wait = int(p[5:])
             self.queue_count.configure(text=f"{self.patient_count} patients")
-            self.wait_label.configure(text=f"⏱ Est. Wait: {self.estimated_wait} min")
+            # WAIT is the median observed time-to-treatment (-1 = nobody treated yet)
+            wait_text = f"{self.estimated_wait} min" if self.estimated_wait >= 0 else "--"
+            self.wait_label.configure(text=f"⏱ Est. Wait: {wait_text}")
+        
+        elif cmd == "SNAPSHOT":
+            # Full resync follows: drop everything the backend knows about
+            # (keeps patients still waiting for their SUCCESS_ADD ID)
+            self.snapshot_previous = {p.id: p for p in self.patients if p.id != 0}
+            self.patients = [p for p in self.patients if p.id == 0]
         
         elif cmd == "LIST_DATA":
             if len(parts) >= 6:
@@ -900,14 +898,60 @@ class DashboardFrame(ctk.CTkFrame):
                 display_name = name.replace("_", " ")
                 display_desc = desc.replace("_", " ")
                 
-                if not any(p.id == pid for p in self.patients):
+                if self.snapshot_previous is not None:
+                    patient = self.snapshot_previous.get(pid)
+                    if patient is None:
+                        patient = PatientViewModel(pid, display_name, age, prio, display_desc)
+                    patient.priority = prio
+                    self.patients.append(patient)
+                elif not any(p.id == pid for p in self.patients):
                     patient = PatientViewModel(pid, display_name, age, prio, display_desc)
                     self.patients.append(patient)
                     self._refresh_sidebar()
         
+        elif cmd == "CHANGE":
+            # CHANGE <ver> ADD|UPDATE|ESCALATE|REMOVE <id> ... (sidebar redrawn once at CHANGES_END)
+            if len(parts) >= 4:
+                kind, pid = parts[2], int(parts[3])
+                if kind == "ADD" and len(parts) >= 8:
+                    prio, age = int(parts[4]), int(parts[5])
+                    display_name = parts[6].replace("_", " ")
+                    display_desc = parts[7].replace("_", " ")
+                    if not any(p.id == pid for p in self.patients):
+                        self.patients.append(PatientViewModel(pid, display_name, age, prio, display_desc))
+                elif kind == "UPDATE" and len(parts) >= 5:
+                    for patient in self.patients:
+                        if patient.id == pid:
+                            patient.priority = int(parts[4])
+                elif kind == "ESCALATE" and len(parts) >= 5:
+                    for patient in self.patients:
+                        if patient.id == pid:
+                            patient.priority = int(parts[4])
+                            if patient.priority <= 2:
+                                self._show_deterioration_alert(patient.name, patient.priority)
+                elif kind == "REMOVE":
+                    self.patients = [p for p in self.patients if p.id != pid]
+                    if self.selected_patient and self.selected_patient.id == pid:
+                        self.selected_patient = None
+                        self._update_monitor()
+        
+        elif cmd in ("CHANGES_END", "SUBSCRIBED", "SNAPSHOT_END"):
+            if len(parts) > 1:
+                self.bridge.set_feed_version(int(parts[1]))
+            if self.snapshot_previous is not None:
+                self.snapshot_previous = None
+                if self.selected_patient and self.selected_patient not in self.patients:
+                    self.selected_patient = None  # Left the queue while we were out of sync
+                    self._update_monitor()
+            self._refresh_sidebar()
+        
+        elif cmd == "CHANGES_RESET":
+            # Fell too far behind (or backend restarted): take a fresh baseline
+            self.bridge.request_snapshot()
+        
         elif cmd == "SUCCESS_UPDATE":
             messagebox.showinfo("Updated", "Patient priority updated.")
-            self.bridge.send_command("STATS")
+            self.bridge.refresh()
         
         elif cmd == "SUCCESS_REMOVE":
             pid = int(parts[1]) if len(parts) > 1 else 0
@@ -916,7 +960,7 @@ class DashboardFrame(ctk.CTkFrame):
                 self.selected_patient = None
             self._refresh_sidebar()
             self._update_monitor()
-            self.bridge.send_command("STATS")
+            self.bridge.refresh()
         
         elif cmd == "SUCCESS_PASS_CHANGE":
             if hasattr(self, '_change_pass_dialog') and self._change_pass_dialog:
@@ -929,8 +973,7 @@ class DashboardFrame(ctk.CTkFrame):
         
         elif cmd == "SUCCESS_MERGE":
             messagebox.showinfo("Mass Casualty", "Patient data merged successfully!")
-            self.bridge.send_command("STATS")
-            self.bridge.send_command("LIST")
+            self.bridge.refresh()
         
         elif cmd == "ERROR_FILE_NOT_FOUND":
             messagebox.showerror("Error", "File not found. Please select a valid file.")
@@ -1279,7 +1322,7 @@ class DashboardFrame(ctk.CTkFrame):
             self.bridge.send_command(f"MERGE {filename}")
     
     def _on_refresh(self) -> None:
-        self.bridge.send_command("STATS")
+        self.bridge.refresh()
     
     def cleanup(self) -> None:
         """Clean up resources when closing."""
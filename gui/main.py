@@ -20,7 +20,7 @@ ctk.set_default_color_theme("blue")
 # Import our modules
 # NOTE: Ensure login_window.py has 'class LoginFrame(ctk.CTkFrame)'
 # NOTE: Ensure dashboard.py has 'class DashboardFrame(ctk.CTkFrame)'
-from bridge import SystemBridge
+from bridge import SystemBridge, RemoteBridge
 from login_window import LoginFrame
 from dashboard import DashboardFrame
 
@@ -158,6 +158,22 @@ def main():
     print("  TRIAGE O.S. - Emergency Room Management")
     print("=" * 50)
     
+    # Remote mode: "python main.py --connect=<host>:<port>" (or unix:<path>)
+    # attaches to a backend started with --listen instead of spawning one
+    connect = next((a.split("=", 1)[1] for a in sys.argv[1:] if a.startswith("--connect=")), None)
+    if connect:
+        bridge = RemoteBridge(connect, coalesce_refresh=True)
+        if not bridge.start():
+            root = ctk.CTk()
+            root.withdraw()
+            messagebox.showerror("Connection Error", f"Could not connect to the backend at {connect}.")
+            root.destroy()
+            sys.exit(1)
+        app = TriageApp(bridge)
+        app.mainloop()
+        print("[Main] Application closed")
+        return
+    
     # Step 1: Find the backend executable
     exe_path = find_backend_executable()
     
@@ -174,7 +190,7 @@ def main():
     print(f"[Main] Found backend at: {exe_path}")
     
     # Step 2: Create and start the bridge
-    bridge = SystemBridge(exe_path)
+    bridge = SystemBridge(exe_path, coalesce_refresh=True)
     
     if not bridge.start():
         root = ctk.CTk()
@@ -0,0 +1,88 @@
+#include "AgingWheel.h"
+#include <chrono>
+
+// ==========================================
+// AGING WHEEL IMPLEMENTATION
+// ==========================================
+
+AgingWheel::AgingWheel() {
+    slots = new AgingTimer*[SLOTS];
+    for (int i = 0; i < SLOTS; i++) slots[i] = nullptr;
+    scale = 1;
+    currentTick = now();
+}
+
+AgingWheel::~AgingWheel() {
+    // AgingTimer is trivially destructible: the pool frees the slabs
+    delete[] slots;
+}
+
+long long AgingWheel::toTick(long long micros) {
+    // Milliseconds first: keeps sub-second precision under a scale without overflowing
+    return micros / 1000 * scale / 1000;
+}
+
+long long AgingWheel::now() {
+    long long micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return toTick(micros);
+}
+
+void AgingWheel::setScale(int factor) {
+    if (factor < 1) factor = 1;
+
+    // Changing the clock moves every deadline, so only call this before
+    // anything is armed (System does it at startup)
+    scale = factor;
+    currentTick = now();
+}
+
+void AgingWheel::link(AgingTimer* timer) {
+    int slot = (int)(timer->deadline % SLOTS);
+    timer->prev = nullptr;
+    timer->next = slots[slot];
+    if (slots[slot] != nullptr) slots[slot]->prev = timer;
+    slots[slot] = timer;
+}
+
+void AgingWheel::unlink(AgingTimer* timer) {
+    if (timer->prev != nullptr) {
+        timer->prev->next = timer->next;
+    } else {
+        slots[timer->deadline % SLOTS] = timer->next;
+    }
+    if (timer->next != nullptr) timer->next->prev = timer->prev;
+    timer->prev = nullptr;
+    timer->next = nullptr;
+}
+
+void AgingWheel::arm(long long id, int priority, long long sinceMicros) {
+    cancel(id);
+    if (priority < MIN_PRIORITY || priority > MAX_PRIORITY) return;
+    if (MAX_WAIT_MINUTES[priority] == 0) return;
+
+    // 1. Deadline in wheel ticks (the wait may have started before a restart)
+    long long since = (sinceMicros == ARRIVAL_NOW) ? now() : toTick(sinceMicros);
+    long long deadline = since + (long long)MAX_WAIT_MINUTES[priority] * 60;
+
+    // 2. Already overdue: file it under the current tick, the next advance() fires it
+    if (deadline < currentTick) deadline = currentTick;
+
+    AgingTimer* timer = pool.acquire(id, deadline, priority);
+    link(timer);
+    index.insert(id, timer, nullptr);
+}
+
+void AgingWheel::cancel(long long id) {
+    IdIndex<AgingTimer, void>::Entry* entry = index.find(id);
+    if (entry == nullptr) return;
+
+    AgingTimer* timer = entry->node;
+    unlink(timer);
+    index.erase(id);
+    pool.release(timer);
+}
+
+int AgingWheel::size() {
+    return index.size();
+}
@@ -0,0 +1,122 @@
+#ifndef AGINGWHEEL_H
+#define AGINGWHEEL_H
+
+#include "NodePool.h"
+#include "PatientIndex.h"
+#include "TriageQueue.h"
+
+// Longest a patient should wait at each ESI level before being escalated
+// one level (minutes; 0 = never escalates). Index = priority.
+const int MAX_WAIT_MINUTES[MAX_PRIORITY + 1] = {
+    0,      // (unused)
+    0,      // ESI 1: already the most urgent
+    10, 30, 60, 120,
+    150, 180, 210, 240, 240
+};
+
+// One armed deadline (intrusive doubly-linked list per wheel slot)
+struct AgingTimer {
+    AgingTimer* prev;
+    AgingTimer* next;
+    long long id;
+    long long deadline;     // Tick (seconds) at which the patient escalates
+    int priority;           // Level the deadline was armed for
+
+    AgingTimer(long long _id, long long _deadline, int _priority)
+        : prev(nullptr), next(nullptr), id(_id), deadline(_deadline), priority(_priority) {}
+};
+
+// Hashed timer wheel for waiting-time escalation.
+//
+// Every waiting patient (ESI 2-10) has one timer, filed in the slot of its
+// deadline. Advancing the clock only visits the slots that passed, and each
+// slot only holds the timers due in it (one revolution covers the longest
+// wait), so the work is proportional to the patients that actually escalate.
+// Arming, re-arming and cancelling are O(1) through an ID index.
+class AgingWheel {
+private:
+    static const int SLOTS = 16384;     // 1 s per slot: ~4.5 h per revolution
+
+    AgingTimer** slots;     // Heap-allocated: System lives on main()'s stack
+    long long currentTick;  // Last tick processed
+    int scale;              // Clock speed-up (1 = real time, 60 = a minute per second)
+
+    SlabPool<AgingTimer> pool;
+    IdIndex<AgingTimer, void> index;
+
+    // Non-copyable: owns the timers
+    AgingWheel(const AgingWheel&);
+    AgingWheel& operator=(const AgingWheel&);
+
+    long long toTick(long long micros);
+    void link(AgingTimer* timer);
+    void unlink(AgingTimer* timer);
+
+public:
+    AgingWheel();
+    ~AgingWheel();
+
+    // Current wheel time (seconds since the epoch, times the scale)
+    long long now();
+
+    // Runs the wheel 'factor' times faster (demos and tests). Call before arm().
+    void setScale(int factor);
+
+    // Starts (or restarts) the wait clock of a patient at 'priority'.
+    // 'sinceMicros' is when the wait began (arrival or last re-triage);
+    // ARRIVAL_NOW means now. ESI 1 patients get no timer.
+    void arm(long long id, int priority, long long sinceMicros);
+
+    // The patient left the queue (treated, LWBS) or no longer needs a timer
+    void cancel(long long id);
+
+    int size();
+
+    // Advances the wheel to now(). Every expired patient is handed to
+    // fire(id, priority) once; its timer is gone by then, so fire() may arm() again.
+    // Returns the number of fired timers.
+    template <typename Fn>
+    int advance(Fn fire) {
+        long long target = now();
+        if (target < currentTick) return 0; // Wall clock stepped back: wait for it
+
+        // 1. Detach everything due, so fire() can safely re-arm.
+        // The current slot is swept again: overdue arms are filed there.
+        AgingTimer* expired = nullptr;
+        long long steps = target - currentTick;
+        if (steps >= SLOTS) steps = SLOTS - 1; // Long pause: one full sweep is enough
+
+        for (long long s = 0; s <= steps; s++) {
+            int slot = (int)((currentTick + s) % SLOTS);
+            AgingTimer* timer = slots[slot];
+            while (timer != nullptr) {
+                AgingTimer* next = timer->next;
+                if (timer->deadline <= target) {
+                    unlink(timer);
+                    timer->next = expired;
+                    expired = timer;
+                }
+                timer = next;
+            }
+        }
+        currentTick = target;
+
+        // 2. Hand them out
+        int fired = 0;
+        while (expired != nullptr) {
+            AgingTimer* timer = expired;
+            expired = timer->next;
+
+            long long id = timer->id;
+            int priority = timer->priority;
+            index.erase(id);
+            pool.release(timer);
+
+            fire(id, priority);
+            fired++;
+        }
+        return fired;
+    }
+};
+
+#endif
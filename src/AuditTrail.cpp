@@ -0,0 +1,299 @@
+#include "AuditTrail.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+// ==========================================
+// AUDIT TRAIL IMPLEMENTATION
+// ==========================================
+
+static const int MIN_PAGES = 16;
+
+AuditTrail::AuditTrail() {
+    pageCapacity = MIN_PAGES;
+    pages = new AuditPage*[pageCapacity];
+    pageCount = 0;
+
+    freeCapacity = AUDIT_PAGE_ROWS;
+    freeRows = new int[freeCapacity];
+    freeCount = 0;
+    nextRow = 0;
+    patients = 0;
+
+    // The first publish() always takes an image, even of an empty queue
+    dirty = true;
+    lastPublish = 0;
+
+    images = new AuditImage*[MAX_IMAGES];
+    firstImage = 0;
+    imageCount = 0;
+}
+
+AuditTrail::~AuditTrail() {
+    // Nobody can be writing an image out any more: the readers are gone
+    for (int i = 0; i < imageCount; i++) {
+        releaseImage(images[(firstImage + i) % MAX_IMAGES]);
+    }
+    delete[] images;
+
+    for (int p = 0; p < pageCount; p++) releasePage(pages[p]);
+    delete[] pages;
+    delete[] freeRows;
+}
+
+long long AuditTrail::nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void AuditTrail::releasePage(AuditPage* page) {
+    if (page->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete page;
+}
+
+void AuditTrail::releaseImage(AuditImage* image) {
+    if (image->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+    for (int p = 0; p < image->pageCount; p++) releasePage(image->pages[p]);
+    delete[] image->pages;
+    delete image;
+}
+
+// ==========================================
+// LIVE TABLE
+// ==========================================
+
+int AuditTrail::takeRow() {
+    if (freeCount > 0) return freeRows[--freeCount];
+    return nextRow++;
+}
+
+PatientRow* AuditTrail::writableRow(int row) {
+    int p = row / AUDIT_PAGE_ROWS;
+
+    // 1. First row of a new page
+    if (p >= pageCount) {
+        if (pageCount == pageCapacity) {
+            AuditPage** grown = new AuditPage*[pageCapacity * 2];
+            for (int i = 0; i < pageCount; i++) grown[i] = pages[i];
+            delete[] pages;
+            pages = grown;
+            pageCapacity *= 2;
+        }
+        pages[pageCount++] = new AuditPage();
+    }
+
+    // 2. Copy on write: an image still holds this page, so it gets a private copy
+    AuditPage* page = pages[p];
+    if (page->refs.load(std::memory_order_acquire) > 1) {
+        AuditPage* copy = new AuditPage();
+        copy->used = page->used;
+        for (int i = 0; i < AUDIT_PAGE_ROWS; i++) copy->rows[i] = page->rows[i];
+        releasePage(page);
+        pages[p] = copy;
+        page = copy;
+    }
+
+    dirty = true;
+    return &page->rows[row % AUDIT_PAGE_ROWS];
+}
+
+void AuditTrail::put(long long id, int priority, int age, long long arrival,
+                     const std::string& name, const std::string& desc) {
+    IdIndex<AuditSlot, void>::Entry* entry = index.find(id);
+    int row;
+    if (entry != nullptr) {
+        row = entry->node->row;
+    } else {
+        row = takeRow();
+        index.insert(id, slotPool.acquire(id, row), nullptr);
+        patients++;
+    }
+
+    PatientRow* target = writableRow(row);
+    target->id = id;
+    target->priority = priority;
+    target->age = age;
+    target->arrival = arrival;
+    target->name = name;
+    target->description = desc;
+    pages[row / AUDIT_PAGE_ROWS]->used |= 1ULL << (row % AUDIT_PAGE_ROWS);
+}
+
+void AuditTrail::setPriority(long long id, int priority) {
+    IdIndex<AuditSlot, void>::Entry* entry = index.find(id);
+    if (entry == nullptr) return;
+    writableRow(entry->node->row)->priority = priority;
+}
+
+void AuditTrail::erase(long long id) {
+    IdIndex<AuditSlot, void>::Entry* entry = index.find(id);
+    if (entry == nullptr) return;
+
+    AuditSlot* slot = entry->node;
+    int row = slot->row;
+    index.erase(id);
+    slotPool.release(slot);
+    patients--;
+
+    // Empty the strings so copies of this page don't carry them around
+    PatientRow* target = writableRow(row);
+    target->name.clear();
+    target->description.clear();
+    pages[row / AUDIT_PAGE_ROWS]->used &= ~(1ULL << (row % AUDIT_PAGE_ROWS));
+
+    if (freeCount == freeCapacity) {
+        int* grown = new int[freeCapacity * 2];
+        for (int i = 0; i < freeCount; i++) grown[i] = freeRows[i];
+        delete[] freeRows;
+        freeRows = grown;
+        freeCapacity *= 2;
+    }
+    freeRows[freeCount++] = row;
+}
+
+// ==========================================
+// IMAGES
+// ==========================================
+
+bool AuditTrail::publish() {
+    long long now = nowSeconds();
+    if (!dirty || (lastPublish != 0 && now - lastPublish < PUBLISH_SECONDS)) return false;
+
+    // 1. Share every page: O(pages), no row is copied here
+    AuditImage* image = new AuditImage();
+    image->refs.store(1, std::memory_order_relaxed);
+    image->takenAt = now;
+    image->patients = patients;
+    image->pageCount = pageCount;
+    image->pages = new AuditPage*[pageCount > 0 ? pageCount : 1];
+    for (int p = 0; p < pageCount; p++) {
+        pages[p]->refs.fetch_add(1, std::memory_order_relaxed);
+        image->pages[p] = pages[p];
+    }
+
+    // 2. File it; the oldest one falls off once the ring is full
+    AuditImage* dropped = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(imageLock);
+        if (imageCount == MAX_IMAGES) {
+            dropped = images[firstImage];
+            firstImage = (firstImage + 1) % MAX_IMAGES;
+            imageCount--;
+        }
+        images[(firstImage + imageCount) % MAX_IMAGES] = image;
+        imageCount++;
+    }
+    if (dropped != nullptr) releaseImage(dropped); // A reader may still hold it
+
+    dirty = false;
+    lastPublish = now;
+    return true;
+}
+
+int AuditTrail::imagesKept() {
+    std::lock_guard<std::mutex> guard(imageLock);
+    return imageCount;
+}
+
+// EXTRACT order of the default engine: priority, then arrival
+static bool auditOrder(const PatientRow* a, const PatientRow* b) {
+    if (a->priority != b->priority) return a->priority < b->priority;
+    if (a->arrival != b->arrival) return a->arrival < b->arrival;
+    return a->id < b->id;
+}
+
+bool AuditTrail::write(long long when, std::ostream& out) {
+    // 1. Latest image taken at or before 'when' (binary search: the ring is in time order)
+    AuditImage* image = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(imageLock);
+        int lo = 0, hi = imageCount - 1, found = -1;
+        while (lo <= hi) {
+            int mid = (lo + hi) / 2;
+            if (images[(firstImage + mid) % MAX_IMAGES]->takenAt <= when) {
+                found = mid;
+                lo = mid + 1;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        if (found < 0) return false;
+
+        image = images[(firstImage + found) % MAX_IMAGES];
+        image->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 2. Outside the lock: the image can't change, and can't go away while we hold it
+    const PatientRow** rows = new const PatientRow*[image->patients > 0 ? image->patients : 1];
+    int n = 0;
+    for (int p = 0; p < image->pageCount; p++) {
+        const AuditPage* page = image->pages[p];
+        for (int i = 0; i < AUDIT_PAGE_ROWS; i++) {
+            if (page->used & (1ULL << i)) rows[n++] = &page->rows[i];
+        }
+    }
+    std::sort(rows, rows + n, auditOrder);
+
+    out << "AUDIT " << image->takenAt << " " << n << "\n";
+    for (int i = 0; i < n; i++) {
+        out << "AUDIT_DATA " << rows[i]->id << " "
+            << rows[i]->priority << " "
+            << rows[i]->age << " "
+            << textField(rows[i]->name) << " "
+            << textField(rows[i]->description) << "\n";
+    }
+    out << "AUDIT_END " << n << "\n";
+
+    delete[] rows;
+    releaseImage(image);
+    return true;
+}
+
+void AuditTrail::query(const std::string& argument, std::ostream& out) {
+    long long when;
+    if (!parseTime(argument, when)) {
+        out << "ERROR: Time must be Unix seconds or HH:MM\n";
+    } else if (!write(when, out)) {
+        out << "ERROR_AUDIT_TOO_OLD\n";
+    }
+}
+
+bool AuditTrail::parseTime(const std::string& token, long long& when) {
+    if (token.empty()) return false;
+
+    // 1. Unix seconds
+    size_t colon = token.find(':');
+    if (colon == std::string::npos) {
+        char* end;
+        long long seconds = strtoll(token.c_str(), &end, 10);
+        if (*end != '\0' || seconds < 0) return false;
+        when = seconds;
+        return true;
+    }
+
+    // 2. HH:MM, local time, the most recent such minute
+    char* end;
+    long hours = strtol(token.c_str(), &end, 10);
+    if (end != token.c_str() + colon) return false;
+    long minutes = strtol(token.c_str() + colon + 1, &end, 10);
+    if (*end != '\0' || end == token.c_str() + colon + 1) return false;
+    if (hours < 0 || hours > 23 || minutes < 0 || minutes > 59) return false;
+
+    time_t now = (time_t)nowSeconds();
+    struct tm local;
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    local.tm_hour = (int)hours;
+    local.tm_min = (int)minutes;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+
+    long long stamp = (long long)mktime(&local);
+    if (stamp > (long long)now) stamp -= 24 * 3600; // Not reached yet today
+    when = stamp;
+    return true;
+}
@@ -0,0 +1,130 @@
+#ifndef AUDITTRAIL_H
+#define AUDITTRAIL_H
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include "NodePool.h"
+#include "Patient.h"
+#include "PatientIndex.h"
+
+// Rows per copy-on-write page
+const int AUDIT_PAGE_ROWS = 64;
+
+// A block of patient rows shared by the live table and every image taken
+// since it last changed. A shared page is never written: the live table
+// copies it first (copy on write), so images stay exactly as published.
+struct AuditPage {
+    std::atomic<int> refs;          // Live table + images holding it
+    unsigned long long used;        // Bit i set = rows[i] holds a patient
+    PatientRow rows[AUDIT_PAGE_ROWS];
+
+    AuditPage() : refs(1), used(0) {}
+};
+
+// The queue as it was at 'takenAt': a copy of the live page table, nothing more
+struct AuditImage {
+    std::atomic<int> refs;          // The trail + readers writing it out
+    long long takenAt;              // Unix seconds
+    int patients;
+    int pageCount;
+    AuditPage** pages;
+};
+
+// Where a patient's row lives in the live table (stable while they are queued)
+struct AuditSlot {
+    long long id;
+    int row;                        // page * AUDIT_PAGE_ROWS + index in the page
+
+    AuditSlot(long long _id, int _row) : id(_id), row(_row) {}
+};
+
+// Point-in-time history of the queue for audit queries ("who was waiting at 02:00?").
+//
+// The owner thread mirrors every change into a paged live table. At most
+// once a minute, and only if something changed, publish() takes an image:
+// it copies the page table and bumps the pages' reference counts, O(n / 64).
+// The first write to a page after that copies just that page. The newest
+// MAX_IMAGES images are kept (a day's worth when something changes every minute).
+//
+// publish() runs on a timer, not just when commands arrive: the owner calls it
+// before every command and at least once a second while idle (the server's
+// poll round, the console's input wait). So a change is in an image at most
+// PUBLISH_SECONDS + 1 s after it happened, and that is the worst an AUDIT
+// answer can lag the queue as it really was at the asked time.
+//
+// Queries never touch the live queue or the live table: write() picks an
+// image under a short lock and formats it, so any thread can answer one
+// (the reader thread does it on its fast path) while the owner carries on.
+class AuditTrail {
+private:
+    static const int PUBLISH_SECONDS = 60;
+    static const int MAX_IMAGES = 24 * 60;  // One day at one image a minute
+
+    // --- Live table (owner thread only) ---
+    AuditPage** pages;
+    int pageCount;
+    int pageCapacity;
+    int* freeRows;          // Rows given back by patients who left, reused first
+    int freeCount;
+    int freeCapacity;
+    int nextRow;            // Rows below this were handed out at least once
+    int patients;
+
+    SlabPool<AuditSlot> slotPool;
+    IdIndex<AuditSlot, void> index;
+
+    bool dirty;             // Changed since the last image
+    long long lastPublish;
+
+    // --- Images (oldest first, ring of MAX_IMAGES) ---
+    std::mutex imageLock;   // Guards the ring, not the images (those are immutable)
+    AuditImage** images;
+    int firstImage;
+    int imageCount;
+
+    // Non-copyable: owns the pages and images
+    AuditTrail(const AuditTrail&);
+    AuditTrail& operator=(const AuditTrail&);
+
+    PatientRow* writableRow(int row);       // Copies a shared page first
+    int takeRow();
+    static void releasePage(AuditPage* page);
+    static void releaseImage(AuditImage* image);
+
+    // Writes the latest image taken at or before 'when' (Unix seconds).
+    // Returns false (and writes nothing) if no image is that old.
+    bool write(long long when, std::ostream& out);
+
+    // Reads the AUDIT argument: Unix seconds, or HH:MM local time meaning the
+    // most recent one (asked at 01:30, "02:00" is yesterday's). false = not a time.
+    static bool parseTime(const std::string& token, long long& when);
+    static long long nowSeconds();
+
+public:
+    AuditTrail();
+    ~AuditTrail();
+
+    // --- Mirroring (owner thread) ---
+    void put(long long id, int priority, int age, long long arrival,
+             const std::string& name, const std::string& desc);
+    void setPriority(long long id, int priority);
+    void erase(long long id);
+
+    // Takes an image if the table changed and the last one is a minute old.
+    // Returns true if an image was taken. Call it at least once a second.
+    bool publish();
+
+    int imagesKept();   // METRICS gauge
+
+    // --- Queries (any thread) ---
+
+    // The AUDIT reply for 'argument' (see parseTime()): the latest image taken
+    // at or before that time as AUDIT <taken at> <count>, <count> AUDIT_DATA
+    // [ID] [PRIO] [AGE] [NAME] [DESC] lines (by priority, then arrival) and
+    // AUDIT_END <count>; or a single ERROR line.
+    void query(const std::string& argument, std::ostream& out);
+};
+
+#endif
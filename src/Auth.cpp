@@ -1,12 +1,45 @@
 #include "Auth.h"
+#include "DurableFile.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <utility>
 
 using namespace std;
 
+static const int MIN_USER_CAPACITY = 64;
+static const char* const KDF_TAG = "pbkdf2-sha256$";
+
 AuthSystem::AuthSystem(string filename) {
     dbFilename = filename;
+    kdfIterations = DEFAULT_KDF_ITERATIONS;
+
+    capacity = MIN_USER_CAPACITY;
+    users = new User[capacity];
+    count = 0;
+    fileLines = 0;
+
+    // Session tags must not be reproducible outside this process
+    random_device rd;
+    for (int i = 0; i < SHA256_BYTES; i++) sessionKey[i] = (unsigned char)rd();
+    unknownSeed = (unsigned long)rd();
+    unknownNames = new UnknownName[UNKNOWN_THROTTLE_SLOTS];
+
+    load();
     ensureAdminExists();
 }
 
+AuthSystem::~AuthSystem() {
+    delete[] users;
+    delete[] unknownNames;
+}
+
+void AuthSystem::setCost(int iterations) {
+    if (iterations >= 1 && iterations <= MAX_KDF_ITERATIONS) kdfIterations = iterations;
+}
+
 // DJB2 Hash Algorithm (Simple, Fast, and Deterministic)
 unsigned long AuthSystem::computeHash(string str) {
     unsigned long hash = HASH_SEED;
@@ -16,68 +49,316 @@ unsigned long AuthSystem::computeHash(string str) {
     return hash;
 }
 
-void AuthSystem::ensureAdminExists() {
-    ifstream infile(dbFilename);
-    if (!infile.good()) {
-        // File doesn't exist, create default admin
-        ofstream outfile(dbFilename);
-        outfile << "admin " << computeHash("admin") << endl;
-        outfile.close();
+long long AuthSystem::nowSeconds() {
+    return chrono::duration_cast<chrono::seconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long long AuthSystem::nowMillis() {
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ==========================================
+// USER TABLE (open addressing, linear probing)
+// ==========================================
+
+// FNV-1a over the username bytes
+static unsigned long long hashName(const string& name) {
+    unsigned long long h = 1469598103934665603ULL;
+    for (size_t i = 0; i < name.size(); i++) {
+        h ^= (unsigned char)name[i];
+        h *= 1099511628211ULL;
     }
-    infile.close();
+    return h;
 }
 
-bool AuthSystem::login(string username, string password) {
-    ifstream file(dbFilename);
-    string u;
-    unsigned long h;
-    
-    unsigned long inputHash = computeHash(password);
-    
-    while (file >> u >> h) {
-        if (u == username) {
-            if (h == inputHash) return true; // Match
-            else return false; // Wrong password
+User* AuthSystem::find(const string& username) {
+    unsigned long long mask = (unsigned long long)(capacity - 1);
+    unsigned long long pos = hashName(username) & mask;
+    while (!users[pos].username.empty()) {
+        if (users[pos].username == username) return &users[pos];
+        pos = (pos + 1) & mask;
+    }
+    return nullptr;
+}
+
+User* AuthSystem::findOrAdd(const string& username) {
+    User* existing = find(username);
+    if (existing != nullptr) return existing;
+
+    // Keep the load factor at or below 3/4
+    if ((count + 1) * 4 > capacity * 3) rehash(capacity * 2);
+
+    unsigned long long mask = (unsigned long long)(capacity - 1);
+    unsigned long long pos = hashName(username) & mask;
+    while (!users[pos].username.empty()) pos = (pos + 1) & mask;
+
+    users[pos].username = username;
+    count++;
+    return &users[pos];
+}
+
+void AuthSystem::rehash(int newCapacity) {
+    User* oldUsers = users;
+    int oldCapacity = capacity;
+
+    users = new User[newCapacity];
+    capacity = newCapacity;
+
+    unsigned long long mask = (unsigned long long)(capacity - 1);
+    for (int i = 0; i < oldCapacity; i++) {
+        if (oldUsers[i].username.empty()) continue;
+
+        unsigned long long pos = hashName(oldUsers[i].username) & mask;
+        while (!users[pos].username.empty()) pos = (pos + 1) & mask;
+        users[pos] = std::move(oldUsers[i]);
+    }
+    delete[] oldUsers;
+}
+
+// ==========================================
+// FILE FORMAT
+// ==========================================
+
+static void writeHex(ostream& out, const unsigned char* bytes, int length) {
+    static const char DIGITS[] = "0123456789abcdef";
+    for (int i = 0; i < length; i++) {
+        out << DIGITS[bytes[i] >> 4] << DIGITS[bytes[i] & 15];
+    }
+}
+
+static bool readHex(const char*& p, unsigned char* bytes, int length) {
+    for (int i = 0; i < length; i++) {
+        int value = 0;
+        for (int half = 0; half < 2; half++) {
+            char c = *p++;
+            int digit;
+            if (c >= '0' && c <= '9') digit = c - '0';
+            else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+            else return false;
+            value = value * 16 + digit;
         }
+        bytes[i] = (unsigned char)value;
     }
-    return false; // User not found
+    return true;
 }
 
-bool AuthSystem::changePassword(string username, string oldPass, string newPass) {
-    
+void AuthSystem::writeUser(ostream& out, const User& user) {
+    out << user.username << " ";
+    if (user.iterations == 0) {
+        out << user.legacyHash;
+    } else {
+        out << KDF_TAG << user.iterations << "$";
+        writeHex(out, user.salt, SALT_BYTES);
+        out << "$";
+        writeHex(out, user.hash, SHA256_BYTES);
+    }
+    out << "\n";
+}
+
+bool AuthSystem::parseLine(const string& line) {
+    size_t space = line.find(' ');
+    if (space == 0 || space == string::npos) return false;
+    string username = line.substr(0, space);
+    const char* p = line.c_str() + space + 1;
+
+    User parsed;
+    if (strncmp(p, KDF_TAG, strlen(KDF_TAG)) == 0) {
+        // pbkdf2-sha256$<iterations>$<salt hex>$<hash hex>
+        p += strlen(KDF_TAG);
+        char* end;
+        long iterations = strtol(p, &end, 10);
+        // Bounded: the count comes from a file, and every LOGIN pays it on the owner thread
+        if (end == p || *end != '$' || iterations < 1 || iterations > MAX_KDF_ITERATIONS) return false;
+        p = end + 1;
+        if (!readHex(p, parsed.salt, SALT_BYTES) || *p++ != '$') return false;
+        if (!readHex(p, parsed.hash, SHA256_BYTES)) return false;
+        parsed.iterations = (int)iterations;
+    } else {
+        // Older versions: a bare DJB2 number
+        char* end;
+        parsed.legacyHash = strtoul(p, &end, 10);
+        if (end == p) return false;
+        parsed.iterations = 0;
+    }
+
+    // A later line for the same user replaces the earlier one
+    User* user = findOrAdd(username);
+    user->iterations = parsed.iterations;
+    user->legacyHash = parsed.legacyHash;
+    memcpy(user->salt, parsed.salt, SALT_BYTES);
+    memcpy(user->hash, parsed.hash, SHA256_BYTES);
+    user->sessionExpiry = 0;
+    return true;
+}
+
+void AuthSystem::load() {
     ifstream file(dbFilename);
-    string u;
-    unsigned long h;
-    
+    string line;
+    while (getline(file, line)) {
+        if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+        if (parseLine(line)) fileLines++;
+    }
+}
+
+void AuthSystem::store(const User& user) {
+    // Once most of the file is superseded lines, rewrite it with one line per user
+    // (if that fails the old file is still there: append to it as usual)
+    if (fileLines + 1 > 2 * count + 8 && compact()) return;
+
+    ofstream file(dbFilename, ios::app);
+    writeUser(file, user);
+    fileLines++;
+}
+
+bool AuthSystem::compact() {
     string tempFilename = dbFilename + ".tmp";
     ofstream tempFile(tempFilename);
-    
-    bool foundAndVerified = false;
-    unsigned long oldHashInput = computeHash(oldPass);
-    unsigned long newHash = computeHash(newPass);
-
-    while (file >> u >> h) {
-        if (u == username) {
-            if (h == oldHashInput) {
-                // Found user and password matches! Write NEW hash.
-                tempFile << u << " " << newHash << endl;
-                foundAndVerified = true;
-            } else {
-                // Wrong password, keep old data
-                tempFile << u << " " << h << endl;
-            }
-        } else {
-            // Just copy other users
-            tempFile << u << " " << h << endl;
-        }
+    for (int i = 0; i < capacity; i++) {
+        if (!users[i].username.empty()) writeUser(tempFile, users[i]);
     }
-    
-    file.close();
     tempFile.close();
-    
-        // Replace old DB with new DB
-    remove(dbFilename.c_str());
-    rename(tempFilename.c_str(), dbFilename.c_str());
-    
-    return foundAndVerified;
-}
\ No newline at end of file
+    if (tempFile.fail()) {
+        remove(tempFilename.c_str());
+        return false;
+    }
+
+    // Replace old DB with new DB (never a moment without one, see replaceFile())
+    if (!replaceFile(tempFilename, dbFilename)) return false;
+    fileLines = count;
+    return true;
+}
+
+void AuthSystem::ensureAdminExists() {
+    ifstream infile(dbFilename);
+    if (!infile.good()) {
+        // File doesn't exist, create default admin
+        User* admin = findOrAdd("admin");
+        setPassword(*admin, "admin");
+        compact();
+    }
+    infile.close();
+}
+
+// ==========================================
+// PASSWORD CHECKS
+// ==========================================
+
+void AuthSystem::setPassword(User& user, const string& password) {
+    random_device rd;
+    for (int i = 0; i < SALT_BYTES; i++) user.salt[i] = (unsigned char)rd();
+
+    user.iterations = kdfIterations;
+    user.legacyHash = 0;
+    pbkdf2Sha256(password, user.salt, SALT_BYTES, user.iterations, user.hash, SHA256_BYTES);
+    user.sessionExpiry = 0;
+}
+
+// HMAC(sessionKey, salt || password): tied to the stored credential, so a
+// password change or re-hash invalidates it even without clearing the expiry
+static void sessionTagFor(const unsigned char* sessionKey, const User& user, const string& password,
+                          unsigned char tag[SHA256_BYTES]) {
+    string message((const char*)user.salt, SALT_BYTES);
+    message += password;
+    hmacSha256(sessionKey, SHA256_BYTES, message.data(), message.size(), tag);
+}
+
+bool AuthSystem::verify(User& user, const string& password) {
+    long long now = nowSeconds();
+    unsigned char tag[SHA256_BYTES];
+
+    // 1. Fast path: this password already passed the KDF during this session
+    if (user.sessionExpiry > now) {
+        sessionTagFor(sessionKey, user, password, tag);
+        if (equalBytes(tag, user.sessionTag, SHA256_BYTES)) return true;
+    }
+
+    // 2. Full check against the stored credential
+    bool match;
+    if (user.iterations == 0) {
+        match = (computeHash(password) == user.legacyHash);
+    } else {
+        unsigned char derived[SHA256_BYTES];
+        pbkdf2Sha256(password, user.salt, SALT_BYTES, user.iterations, derived, SHA256_BYTES);
+        match = equalBytes(derived, user.hash, SHA256_BYTES);
+    }
+    if (!match) return false;
+
+    // 3. Legacy or re-tuned entry: re-hash at the current cost while we have the password
+    if (user.iterations != kdfIterations) {
+        setPassword(user, password);
+        store(user);
+    }
+
+    sessionTagFor(sessionKey, user, password, user.sessionTag);
+    user.sessionExpiry = now + SESSION_CACHE_SECONDS;
+    return true;
+}
+
+void AuthSystem::noteFailure(LoginThrottle& throttle, long long now) {
+    throttle.failures++;
+    if (throttle.failures < FREE_LOGIN_FAILURES) return;
+
+    // 1, 2, 4 ... seconds, capped
+    int doublings = throttle.failures - FREE_LOGIN_FAILURES;
+    long long backoff = doublings < 6 ? (1LL << doublings) : MAX_LOGIN_BACKOFF_SECONDS;
+    if (backoff > MAX_LOGIN_BACKOFF_SECONDS) backoff = MAX_LOGIN_BACKOFF_SECONDS;
+    throttle.blockedUntil = now + backoff * 1000;
+}
+
+LoginThrottle& AuthSystem::unknownThrottle(const string& username) {
+    unsigned long hash = unknownSeed;
+    for (char c : username) hash = (hash * 33) ^ (unsigned char)c;
+    hash ^= hash >> 16;
+
+    UnknownName& slot = unknownNames[hash & (UNKNOWN_THROTTLE_SLOTS - 1)];
+    if (slot.name != username) {
+        // Someone else's slot: it starts over for this name
+        slot.name = username;
+        slot.throttle = LoginThrottle();
+    }
+    return slot.throttle;
+}
+
+bool AuthSystem::attempt(const string& username, const string& password) {
+    User* user = find(username);
+    LoginThrottle& throttle = (user != nullptr) ? user->throttle : unknownThrottle(username);
+    long long now = nowMillis();
+
+    // 1. In the backoff: no KDF, no session cache (that would be a fast oracle)
+    if (throttle.blockedUntil > now) return false;
+
+    // 2. The check itself
+    bool ok;
+    if (user == nullptr) {
+        // Unknown names cost as much as wrong passwords, so timing doesn't list the staff
+        unsigned char salt[SALT_BYTES] = { 0 };
+        unsigned char derived[SHA256_BYTES];
+        pbkdf2Sha256(password, salt, SALT_BYTES, kdfIterations, derived, SHA256_BYTES);
+        ok = false;
+    } else {
+        ok = verify(*user, password);
+    }
+
+    // 3. Count it
+    if (ok) {
+        throttle.failures = 0;
+        throttle.blockedUntil = 0;
+    } else {
+        noteFailure(throttle, now);
+    }
+    return ok;
+}
+
+bool AuthSystem::login(string username, string password) {
+    return attempt(username, password);
+}
+
+bool AuthSystem::changePassword(string username, string oldPass, string newPass) {
+    if (!attempt(username, oldPass)) return false;
+    User* user = find(username);
+
+    // New salt and hash; the old password's session tag no longer applies
+    setPassword(*user, newPass);
+    store(*user);
+    return true;
+}
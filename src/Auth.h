@@ -4,30 +4,130 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include "Kdf.h"
 
-// A constant specific to the custom hash function
-const unsigned long HASH_SEED = 5381; 
+// Seed of the legacy DJB2 hash (read from old users_db.txt files only)
+const unsigned long HASH_SEED = 5381;
+
+const int SALT_BYTES = 16;
+const int DEFAULT_KDF_ITERATIONS = 20000;        // ~15 ms per LOGIN; --auth-cost=N to tune
+const int MAX_KDF_ITERATIONS = 1000000;          // ~0.75 s: above this a LOGIN is an outage
+const long long SESSION_CACHE_SECONDS = 12 * 3600; // One shift
+
+// Failed-login backoff. A few misses in a row are free; after that the name
+// is refused without running the KDF for 1, 2, 4 ... up to 60 seconds.
+// LOGIN runs on the owner thread, so this is what bounds the time a stream
+// of wrong passwords can take from the queue: one KDF per name per backoff.
+const int FREE_LOGIN_FAILURES = 3;
+const long long MAX_LOGIN_BACKOFF_SECONDS = 60;
+
+struct LoginThrottle {
+    int failures;                   // Misses since the last success
+    long long blockedUntil;         // Steady-clock milliseconds; 0 = not blocked
+
+    LoginThrottle() : failures(0), blockedUntil(0) {}
+};
+
+// Names not in the user table get a throttle of their own too, or a
+// blocked unknown name would answer faster than a real one and list the
+// staff. They live in a fixed table, slot = keyed hash of the name; a new
+// name takes over its slot. The key is random per process, so nobody can
+// aim names at one slot: evicting a given entry means trying about
+// UNKNOWN_THROTTLE_SLOTS other names, each paying the full KDF.
+const int UNKNOWN_THROTTLE_SLOTS = 1024;    // Power of two
+
+struct UnknownName {
+    std::string name;               // Empty = free slot
+    LoginThrottle throttle;
+};
 
 struct User {
-    std::string username;
-    unsigned long passwordHash; // We store the hash, not the text
+    std::string username;           // Empty = free table slot
+
+    // Stored credential: PBKDF2-HMAC-SHA256(password, salt, iterations).
+    // iterations == 0 marks a legacy DJB2 entry, upgraded on its next login.
+    int iterations;
+    unsigned char salt[SALT_BYTES];
+    unsigned char hash[SHA256_BYTES];
+    unsigned long legacyHash;
+
+    // Verified-session cache: HMAC of the last password that passed the KDF,
+    // under a key that only lives in this process. A matching re-login within
+    // the window costs one HMAC instead of the full KDF.
+    unsigned char sessionTag[SHA256_BYTES];
+    long long sessionExpiry;        // Steady-clock seconds; 0 = nothing cached
+
+    LoginThrottle throttle;
+
+    User() : iterations(0), legacyHash(0), sessionExpiry(0) {}
 };
 
+// Staff credentials.
+//
+// users_db.txt is read once at startup into an open-addressing table
+// (linear probing on the username), so LOGIN never touches the disk.
+// Changes are appended to the file as new lines that override earlier ones
+// on the next load; once the file holds twice as many lines as users it is
+// rewritten (via a .tmp file and replaceFile()).
+//
+// File lines: "<username> pbkdf2-sha256$<iterations>$<salt hex>$<hash hex>",
+// or "<username> <DJB2 number>" from older versions.
 class AuthSystem {
 private:
     std::string dbFilename;
-    
-    // Custom deterministic hash function (DJB2 Algorithm)
+    int kdfIterations;      // Cost of newly stored passwords
+
+    User* users;
+    int capacity;           // Power of two
+    int count;
+    int fileLines;          // Lines in the file (compaction trigger)
+
+    unsigned char sessionKey[SHA256_BYTES]; // Random per process
+    UnknownName* unknownNames;              // UNKNOWN_THROTTLE_SLOTS entries
+    unsigned long unknownSeed;              // Random per process (slot hash key)
+
+    // Non-copyable: owns the user table
+    AuthSystem(const AuthSystem&);
+    AuthSystem& operator=(const AuthSystem&);
+
+    // Custom deterministic hash function (DJB2 Algorithm), legacy entries only.
     // We use this because std::hash can change between program runs.
     unsigned long computeHash(std::string str);
 
+    User* find(const std::string& username);
+    User* findOrAdd(const std::string& username);
+    void rehash(int newCapacity);
+
+    void load();
+    bool parseLine(const std::string& line);
+    void setPassword(User& user, const std::string& password); // New salt, current cost
+    bool verify(User& user, const std::string& password);      // Session cache, then KDF
+    LoginThrottle& unknownThrottle(const std::string& username);
+    bool attempt(const std::string& username, const std::string& password); // verify() behind the backoff
+    void store(const User& user);                              // Append (or compact)
+    bool compact();                                            // false = old file kept
+
+    static void writeUser(std::ostream& out, const User& user);
+    static long long nowSeconds();
+    static long long nowMillis();   // Backoff clock: a whole-second one could end a 1 s block at once
+    static void noteFailure(LoginThrottle& throttle, long long now);
+
 public:
     AuthSystem(std::string filename = "users_db.txt");
-    
-    // Core Logic
+    ~AuthSystem();
+
+    // Core Logic. A name in its failed-login backoff (see LoginThrottle) is
+    // refused at once, right password or not.
     bool login(std::string username, std::string password);
     bool changePassword(std::string username, std::string oldPass, std::string newPass);
     void ensureAdminExists(); // Creates default admin if file missing
+
+    // KDF iterations for passwords stored from now on. Existing entries with
+    // a different cost are re-hashed the next time their password goes
+    // through the KDF (a login that misses the session cache).
+    // Values outside 1..MAX_KDF_ITERATIONS are ignored.
+    void setCost(int iterations);
+    int getCost() { return kdfIterations; }
 };
 
-#endif
\ No newline at end of file
+#endif
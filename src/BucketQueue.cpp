@@ -0,0 +1,423 @@
+#include "BucketQueue.h"
+#include <fstream>
+#include <utility>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// ==========================================
+// BUCKET QUEUE IMPLEMENTATION
+// ==========================================
+
+// Index of the lowest set bit (mask must not be 0)
+static inline int lowestBit(unsigned int mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+BucketQueue::BucketQueue() {
+    for (int i = 0; i < LEVELS; i++) heads[i] = nullptr;
+    nonEmpty = 0;
+    numNodes = 0;
+    retired = nullptr;
+    retiredRecord = nullptr;
+}
+
+BucketQueue::~BucketQueue() {
+    recycleRetired();
+
+    // Bulk teardown: the records' strings are freed in one flat sweep of the
+    // index; nodes need no destructor and the pools free their slabs whole
+    int cap = index.getCapacity();
+    for (int i = 0; i < cap; i++) {
+        IndexEntry* entry = index.slotAt(i);
+        if (entry->node != nullptr) records.destroy(entry->record);
+    }
+}
+
+void BucketQueue::recycleRetired() {
+    if (retired != nullptr) {
+        records.release(retiredRecord);
+        pool.release(retired);
+        retired = nullptr;
+        retiredRecord = nullptr;
+    }
+}
+
+void BucketQueue::fill(Node* node, PatientRecord* rec, TriageEntry& out) {
+    out.id = node->id;
+    out.priority = EsiArrivalKey::level(node->key);
+    out.arrival = EsiArrivalKey::arrival(node->key);
+    out.record = rec;
+}
+
+// ------------------------------------------
+// Level lists
+// ------------------------------------------
+
+void BucketQueue::pushBack(Node* node) {
+    int level = levelOf(node);
+    Node* head = heads[level];
+
+    if (head == nullptr) {
+        node->left = node;
+        node->right = node;
+        heads[level] = node;
+        nonEmpty |= (1u << level);
+    } else {
+        // The tail sits left of the head: inserting after it keeps FIFO order
+        head->left->addSibling(node);
+    }
+}
+
+void BucketQueue::placeByArrival(Node* node) {
+    int level = levelOf(node);
+    Node* head = heads[level];
+
+    // Common case: the newest patient of the level goes to the back
+    if (head == nullptr || head->left->key <= node->key) {
+        pushBack(node);
+        return;
+    }
+
+    // Walk back from the tail past everyone who arrived later
+    Node* later = head->left;
+    while (later != head && later->left->key > node->key) later = later->left;
+
+    later->left->addSibling(node);
+    if (later == head) heads[level] = node;
+}
+
+void BucketQueue::unlink(Node* node) {
+    int level = levelOf(node);
+
+    if (node->right == node) {
+        heads[level] = nullptr;
+        nonEmpty &= ~(1u << level);
+    } else if (heads[level] == node) {
+        heads[level] = node->right;
+    }
+    node->removeSelf();
+}
+
+int BucketQueue::lowestLevel() {
+    return lowestBit(nonEmpty);
+}
+
+// ------------------------------------------
+// Queue operations
+// ------------------------------------------
+
+bool BucketQueue::insert(long long id, int priority, int age, std::string name, std::string desc,
+                         long long arrival) {
+    if (priority < MIN_PRIORITY || priority > MAX_PRIORITY) return false;
+    if (index.find(id) != nullptr) return false; // ID already queued
+
+    // New arrivals go to the back; restored ones (UNDO, replay) back into their place
+    if (arrival == ARRIVAL_NOW) arrival = arrivalClock();
+    else noteArrival(arrival);
+
+    Node* node = pool.acquire(id, EsiArrivalKey::pack(priority, age, arrival));
+    PatientRecord* rec = records.acquire(id, age, std::move(name), std::move(desc));
+    placeByArrival(node);
+
+    index.insert(id, node, rec);
+    numNodes++;
+    return true;
+}
+
+int BucketQueue::insertMany(PatientRow* rows, int count) {
+    // insert() is already O(1) with no restructuring to save; just size once
+    reserve(count);
+
+    int added = 0;
+    for (int i = 0; i < count; i++) {
+        PatientRow& row = rows[i];
+        if (insert(row.id, row.priority, row.age, std::move(row.name), std::move(row.description),
+                   row.arrival)) {
+            added++;
+        }
+    }
+    return added;
+}
+
+bool BucketQueue::peek(TriageEntry& out) {
+    if (nonEmpty == 0) return false;
+
+    Node* node = heads[lowestLevel()];
+    fill(node, index.find(node->id)->record, out);
+    return true;
+}
+
+bool BucketQueue::extractMin(TriageEntry& out) {
+    // The previously extracted node is no longer needed by the caller
+    recycleRetired();
+    if (nonEmpty == 0) return false;
+
+    Node* node = heads[lowestLevel()];
+    IndexEntry* entry = index.find(node->id);
+    PatientRecord* rec = entry->record;
+
+    unlink(node);
+    index.erase(node->id);
+    numNodes--;
+
+    retired = node;
+    retiredRecord = rec;
+
+    fill(node, rec, out);
+    return true;
+}
+
+PatientRecord* BucketQueue::getRecord(long long id) {
+    IndexEntry* entry = index.find(id);
+    if (entry != nullptr) return entry->record;
+
+    // The patient just handed out by extractMin() is no longer indexed
+    if (retired != nullptr && retired->id == id) return retiredRecord;
+    return nullptr;
+}
+
+bool BucketQueue::find(long long id, TriageEntry& out) {
+    IndexEntry* entry = index.find(id);
+    if (entry == nullptr) return false;
+    fill(entry->node, entry->record, out);
+    return true;
+}
+
+bool BucketQueue::updatePriority(long long id, int newPriority) {
+    if (newPriority < MIN_PRIORITY || newPriority > MAX_PRIORITY) return false;
+
+    IndexEntry* entry = index.find(id);
+    if (entry == nullptr) return false;
+
+    // Moving to another level keeps the arrival: the patient goes ahead of
+    // everyone in that level who arrived later (the heap engines' order)
+    Node* node = entry->node;
+    if (EsiArrivalKey::level(node->key) == newPriority) return true;
+    unlink(node);
+    node->key = EsiArrivalKey::withLevel(node->key, newPriority);
+    placeByArrival(node);
+    return true;
+}
+
+bool BucketQueue::removePatient(long long id) {
+    IndexEntry* entry = index.find(id);
+    if (entry == nullptr) return false;
+
+    Node* node = entry->node;
+    unlink(node);
+    records.release(entry->record);
+    index.erase(id);
+    pool.release(node);
+    numNodes--;
+    return true;
+}
+
+int BucketQueue::removePatients(const long long* ids, int count, bool* removedFlags) {
+    // Every removal is already O(1): no deferred work to share
+    int removed = 0;
+    for (int i = 0; i < count; i++) {
+        removedFlags[i] = removePatient(ids[i]);
+        if (removedFlags[i]) removed++;
+    }
+    return removed;
+}
+
+bool BucketQueue::merge(TriageQueue& other, long long& collidingId) {
+    // MERGE always builds its scratch queue with createEmpty(), so this holds
+    BucketQueue* src = dynamic_cast<BucketQueue*>(&other);
+    if (src == nullptr) {
+        collidingId = -1;
+        return false;
+    }
+    if (src == this || src->numNodes == 0) return true;
+
+    // Move the index first: it refuses the merge on duplicate IDs
+    if (!index.absorb(src->index, collidingId)) {
+        return false;
+    }
+
+    // The incoming nodes live in src's slabs: take ownership of them
+    src->recycleRetired();
+    pool.adopt(src->pool);
+    records.adopt(src->records);
+
+    // O(1) per level: splice src's list behind ours (arrivals go to the back)
+    for (int i = 0; i < LEVELS; i++) {
+        Node* theirs = src->heads[i];
+        if (theirs == nullptr) continue;
+
+        Node* mine = heads[i];
+        if (mine == nullptr) {
+            heads[i] = theirs;
+        } else {
+            Node* myTail = mine->left;
+            Node* theirTail = theirs->left;
+
+            myTail->right = theirs;
+            theirs->left = myTail;
+            theirTail->right = mine;
+            mine->left = theirTail;
+        }
+        src->heads[i] = nullptr;
+    }
+
+    nonEmpty |= src->nonEmpty;
+    numNodes += src->numNodes;
+    src->nonEmpty = 0;
+    src->numNodes = 0;
+    return true;
+}
+
+bool BucketQueue::transfer(long long id, TriageQueue& target) {
+    BucketQueue* dst = dynamic_cast<BucketQueue*>(&target);
+    if (dst == nullptr || dst == this) return false;
+
+    IndexEntry* entry = index.find(id);
+    if (entry == nullptr || dst->index.find(id) != nullptr) return false;
+
+    // Same node and record: out of our level list, into theirs by arrival
+    // (like UPDATE, the patient keeps their place among later arrivals)
+    Node* node = entry->node;
+    PatientRecord* rec = entry->record;
+    unlink(node);
+    index.erase(id);
+    numNodes--;
+
+    dst->placeByArrival(node);
+    dst->index.insert(id, node, rec);
+    dst->numNodes++;
+
+    // dst recycles the slots when the patient leaves; our slabs must outlive that
+    pool.handOver(dst->pool);
+    records.handOver(dst->records);
+    return true;
+}
+
+void BucketQueue::adoptStorage(TriageQueue& other) {
+    BucketQueue* src = dynamic_cast<BucketQueue*>(&other);
+    if (src == nullptr || src == this) return;
+
+    // Only the slabs move: src still lists its own patients for its destructor
+    src->recycleRetired();
+    pool.adopt(src->pool);
+    records.adopt(src->records);
+}
+
+// ------------------------------------------
+// Bookkeeping and output
+// ------------------------------------------
+
+void BucketQueue::reserve(int n) {
+    if (n <= 0) return;
+    pool.reserve(n);
+    records.reserve(n);
+    index.reserve(index.size() + n);
+}
+
+int BucketQueue::getNumNodes() {
+    return numNodes;
+}
+
+PoolStats BucketQueue::getPoolStats() {
+    return pool.getStats();
+}
+
+bool BucketQueue::getHeapShape(HeapShape&) {
+    return false;
+}
+
+void BucketQueue::visitPatients(PatientVisitor& visitor) {
+    // Level by level, oldest first: the order EXTRACT would hand them out
+    unsigned int mask = nonEmpty;
+    while (mask != 0) {
+        int level = lowestBit(mask);
+        mask &= mask - 1;
+
+        Node* head = heads[level];
+        Node* curr = head;
+        do {
+            TriageEntry entry;
+            fill(curr, index.find(curr->id)->record, entry);
+            visitor.visit(entry);
+            curr = curr->right;
+        } while (curr != head);
+    }
+}
+
+int BucketQueue::visitLevels(int lo, int hi, int limit, PatientVisitor& visitor) {
+    if (lo < MIN_PRIORITY) lo = MIN_PRIORITY;
+    if (hi > MAX_PRIORITY) hi = MAX_PRIORITY;
+    if (lo > hi || limit == 0) return 0;
+
+    // Keep only the non-empty levels inside [lo, hi]
+    unsigned int wanted = ((1u << (hi - MIN_PRIORITY + 1)) - 1) & ~((1u << (lo - MIN_PRIORITY)) - 1);
+    unsigned int mask = nonEmpty & wanted;
+
+    int visited = 0;
+    while (mask != 0) {
+        int level = lowestBit(mask);
+        mask &= mask - 1;
+
+        Node* head = heads[level];
+        Node* curr = head;
+        do {
+            TriageEntry entry;
+            fill(curr, index.find(curr->id)->record, entry);
+            visitor.visit(entry);
+            if (++visited == limit) return visited;
+            curr = curr->right;
+        } while (curr != head);
+    }
+    return visited;
+}
+
+int BucketQueue::visitTopK(int k, PatientVisitor& visitor) {
+    if (k <= 0) return 0;
+    return visitLevels(MIN_PRIORITY, MAX_PRIORITY, k, visitor);
+}
+
+int BucketQueue::visitRange(int lo, int hi, PatientVisitor& visitor) {
+    return visitLevels(lo, hi, -1, visitor);
+}
+
+bool BucketQueue::saveToFile(std::string filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) return false;
+
+    forEachPatient([&file](const TriageEntry& e) {
+        file << e.id << " "
+             << e.priority << " "
+             << e.record->age << " "
+             << textField(e.record->name) << " "
+             << textField(e.record->description) << "\n";
+    });
+    file.close();
+    return true;
+}
+
+void BucketQueue::printAll(std::ostream& out) {
+    // No flush here: the caller flushes once per command (or per batch)
+    forEachPatient([&out](const TriageEntry& e) {
+        out << "LIST_DATA " << e.id << " "
+            << e.priority << " "
+            << e.record->age << " "
+            << textField(e.record->name) << " "
+            << textField(e.record->description) << "\n";
+    });
+}
+
+TriageQueue* BucketQueue::createEmpty() {
+    return new BucketQueue();
+}
+
+const char* BucketQueue::engineName() {
+    return "bucket";
+}
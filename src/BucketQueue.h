@@ -0,0 +1,87 @@
+#ifndef BUCKETQUEUE_H
+#define BUCKETQUEUE_H
+
+#include "TriageQueue.h"
+#include "Node.h"
+#include "NodePool.h"
+#include "Patient.h"
+#include "PatientIndex.h"
+
+// TriageQueue engine specialized for the bounded ESI range (1-10).
+//
+// One intrusive circular list per priority level (linked through
+// Node::left/right), kept in arrival order, plus a bitmask of the non-empty
+// levels. Patients of equal priority come out by arrival, like the heap
+// engines: an UPDATE, TRANSFER or UNDO keeps the patient's place in line
+// among those who arrived later. Nodes carry an EsiArrivalKey.
+//
+// extractMin and removePatient are O(1). So is insert for a new arrival (it
+// goes to the back); a patient who arrived earlier walks back from the tail
+// past the k patients of that level who arrived after them, O(k).
+class BucketQueue : public TriageQueue {
+private:
+    static const int LEVELS = MAX_PRIORITY - MIN_PRIORITY + 1;
+
+    Node* heads[LEVELS];    // Oldest patient of each level (nullptr = empty)
+    unsigned int nonEmpty;  // Bit i set <=> heads[i] != nullptr
+    int numNodes;
+
+    NodePool pool;
+    PatientTable records;
+    PatientIndex index;
+
+    // Same deferral as the FibonacciHeap: the last extracted node stays
+    // valid (for getRecord) until the next extractMin()
+    Node* retired;
+    PatientRecord* retiredRecord;
+
+    void pushBack(Node* node);  // Appends to the tail of its level
+    void placeByArrival(Node* node); // Into its level, behind everyone who arrived earlier
+    void unlink(Node* node);    // Takes the node out of its level
+    int lowestLevel();          // Index of the most urgent non-empty level
+    void recycleRetired();
+
+    // Walks levels lo..hi in EXTRACT order; stops after 'limit' patients (-1 = all)
+    int visitLevels(int lo, int hi, int limit, PatientVisitor& visitor);
+
+    static int levelOf(Node* node) { return EsiArrivalKey::level(node->key) - MIN_PRIORITY; }
+    static void fill(Node* node, PatientRecord* rec, TriageEntry& out);
+
+    // Non-copyable: owns the node pool and record table
+    BucketQueue(const BucketQueue&);
+    BucketQueue& operator=(const BucketQueue&);
+
+public:
+    BucketQueue();
+    ~BucketQueue();
+
+    bool insert(long long id, int priority, int age, std::string name, std::string desc,
+                long long arrival = ARRIVAL_NOW);
+    bool peek(TriageEntry& out);
+    bool extractMin(TriageEntry& out);
+    PatientRecord* getRecord(long long id);
+    bool find(long long id, TriageEntry& out);
+
+    bool updatePriority(long long id, int newPriority);
+    bool removePatient(long long id);
+    int removePatients(const long long* ids, int count, bool* removedFlags);
+    int insertMany(PatientRow* rows, int count);
+    bool merge(TriageQueue& other, long long& collidingId);
+    bool transfer(long long id, TriageQueue& target);
+    void adoptStorage(TriageQueue& other);
+
+    void reserve(int n);
+    int getNumNodes();
+    PoolStats getPoolStats();
+    bool getHeapShape(HeapShape& out);  // No heap: always false
+    bool saveToFile(std::string filename);
+    void printAll(std::ostream& out);   // Priority order, by arrival within a level
+    void visitPatients(PatientVisitor& visitor);
+    int visitTopK(int k, PatientVisitor& visitor);
+    int visitRange(int lo, int hi, PatientVisitor& visitor);
+
+    TriageQueue* createEmpty();
+    const char* engineName();
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "ChangeFeed.h"
+#include "Patient.h"
+
+// ==========================================
+// CHANGE FEED IMPLEMENTATION
+// ==========================================
+
+ChangeFeed::ChangeFeed() {
+    ring = new ChangeEvent[CAPACITY];
+    version = 0;
+    count = 0;
+}
+
+ChangeFeed::~ChangeFeed() {
+    delete[] ring;
+}
+
+ChangeEvent& ChangeFeed::push(ChangeType type, long long id, int priority) {
+    version++;
+    if (count < CAPACITY) count++; // Oldest event is overwritten once full
+
+    ChangeEvent& ev = ring[version % CAPACITY];
+    ev.version = version;
+    ev.type = type;
+    ev.id = id;
+    ev.priority = priority;
+    // Only ADD events carry the record; don't keep stale strings around
+    ev.name.clear();
+    ev.description.clear();
+    return ev;
+}
+
+void ChangeFeed::recordAdd(long long id, int priority, int age, std::string name, std::string desc) {
+    ChangeEvent& ev = push(CHANGE_ADD, id, priority);
+    ev.age = age;
+    ev.name = name;
+    ev.description = desc;
+}
+
+void ChangeFeed::recordUpdate(long long id, int priority) {
+    push(CHANGE_UPDATE, id, priority);
+}
+
+void ChangeFeed::recordRemove(long long id) {
+    push(CHANGE_REMOVE, id, 0);
+}
+
+void ChangeFeed::recordEscalate(long long id, int priority) {
+    push(CHANGE_ESCALATE, id, priority);
+}
+
+long long ChangeFeed::getVersion() {
+    return version;
+}
+
+void ChangeFeed::rollback(long long mark) {
+    if (mark >= version) return;
+
+    long long dropped = version - mark;
+    if (dropped > count) dropped = count;
+    count -= (int)dropped;
+    version = mark;
+}
+
+void ChangeFeed::writeSince(long long since, std::ostream& out) {
+    long long oldest = version - count + 1;
+
+    // Client is from the future (backend restarted) or too far behind
+    if (since > version || since < oldest - 1) {
+        out << "CHANGES_RESET " << version << "\n";
+        return;
+    }
+
+    for (long long v = since + 1; v <= version; v++) {
+        ChangeEvent& ev = ring[v % CAPACITY];
+        out << "CHANGE " << ev.version << " ";
+        switch (ev.type) {
+            case CHANGE_ADD:
+                out << "ADD " << ev.id << " " << ev.priority << " " << ev.age << " "
+                    << textField(ev.name) << " " << textField(ev.description) << "\n";
+                break;
+            case CHANGE_UPDATE:
+                out << "UPDATE " << ev.id << " " << ev.priority << "\n";
+                break;
+            case CHANGE_REMOVE:
+                out << "REMOVE " << ev.id << "\n";
+                break;
+            case CHANGE_ESCALATE:
+                out << "ESCALATE " << ev.id << " " << ev.priority << "\n";
+                break;
+        }
+    }
+    out << "CHANGES_END " << version << "\n";
+}
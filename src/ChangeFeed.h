@@ -0,0 +1,59 @@
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include <string>
+#include <ostream>
+
+// Kinds of queue changes a dashboard needs to stay in sync
+enum ChangeType {
+    CHANGE_ADD,         // New patient in the queue (carries the full record)
+    CHANGE_UPDATE,      // Priority changed
+    CHANGE_REMOVE,      // Patient left the queue (treated, LWBS, ...)
+    CHANGE_ESCALATE     // Waited past the limit for their level: priority raised by the backend
+};
+
+struct ChangeEvent {
+    long long version;
+    ChangeType type;
+    long long id;
+    int priority;
+    int age;
+    std::string name;
+    std::string description;
+};
+
+// Versioned change log for incremental dashboard sync.
+// Every mutation bumps the version and is kept in a fixed-size ring buffer,
+// so "CHANGES <since>" only emits what the client has not seen yet.
+class ChangeFeed {
+private:
+    static const int CAPACITY = 4096; // Events kept for catching up
+
+    ChangeEvent* ring;  // Heap-allocated: System lives on main()'s stack
+    long long version;  // Version of the newest event (0 = nothing happened yet)
+    int count;          // Events currently held (<= CAPACITY)
+
+    ChangeEvent& push(ChangeType type, long long id, int priority);
+
+public:
+    ChangeFeed();
+    ~ChangeFeed();
+
+    void recordAdd(long long id, int priority, int age, std::string name, std::string desc);
+    void recordUpdate(long long id, int priority);
+    void recordRemove(long long id);
+    void recordEscalate(long long id, int priority);
+
+    long long getVersion();
+
+    // Drops every event newer than 'mark' (a version returned by getVersion()).
+    // Used when a multi-patient operation fails after recording started.
+    void rollback(long long mark);
+
+    // Writes all events after 'since' as CHANGE lines followed by CHANGES_END.
+    // If the ring no longer holds them, writes CHANGES_RESET instead so the
+    // client knows it has to SUBSCRIBE again for a full baseline.
+    void writeSince(long long since, std::ostream& out);
+};
+
+#endif
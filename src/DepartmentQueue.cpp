@@ -0,0 +1,476 @@
+#include "DepartmentQueue.h"
+#include "DurableFile.h"
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+// ==========================================
+// DEPARTMENT QUEUE IMPLEMENTATION
+// ==========================================
+
+static const int MAX_NAME_LENGTH = 32;
+
+// Cross-department order (see the class comment): ESI, then arrival
+static bool urgentFirst(const TriageEntry& a, const TriageEntry& b) {
+    if (a.priority != b.priority) return a.priority < b.priority;
+    return a.arrival < b.arrival;
+}
+
+static void writePatient(std::ostream& out, const TriageEntry& e) {
+    out << e.id << " "
+        << e.priority << " "
+        << e.record->age << " "
+        << textField(e.record->name) << " "
+        << textField(e.record->description) << "\n";
+}
+
+DepartmentQueue::DepartmentQueue(TriageQueue* main) {
+    departments[0].name = "main";
+    departments[0].queue = main;
+    count = 1;
+    lastExtracted = nullptr;
+}
+
+DepartmentQueue::~DepartmentQueue() {
+    // 1. Transferred patients still live in the slabs of the department they
+    // came from, so department 0 takes every slab before anyone is destroyed
+    for (int d = 1; d < count; d++) {
+        departments[0].queue->adoptStorage(*departments[d].queue);
+    }
+
+    // 2. The others only destroy their own patients' records, then hold no memory;
+    // department 0 frees all of it last
+    for (int d = count - 1; d >= 1; d--) delete departments[d].queue;
+    delete departments[0].queue;
+}
+
+bool DepartmentQueue::addDepartment(const std::string& name) {
+    if (count == MAX_DEPARTMENTS) return false;
+    if (name.empty() || name.size() > (size_t)MAX_NAME_LENGTH) return false;
+    for (size_t i = 0; i < name.size(); i++) {
+        char c = name[i];
+        bool plain = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                     c == '_' || c == '-';
+        if (!plain) return false;
+    }
+    if (findDepartment(name) >= 0) return false;
+
+    departments[count].name = name;
+    departments[count].queue = departments[0].queue->createEmpty();
+    count++;
+    return true;
+}
+
+int DepartmentQueue::findDepartment(const std::string& name) {
+    for (int d = 0; d < count; d++) {
+        if (departments[d].name == name) return d;
+    }
+    return -1;
+}
+
+Department* DepartmentQueue::homeOf(long long id) {
+    IdIndex<Department, void>::Entry* entry = homes.find(id);
+    return (entry != nullptr) ? entry->node : nullptr;
+}
+
+int DepartmentQueue::departmentOf(long long id) {
+    Department* home = homeOf(id);
+    return (home != nullptr) ? (int)(home - departments) : -1;
+}
+
+// ------------------------------------------
+// Per-department operations
+// ------------------------------------------
+
+bool DepartmentQueue::insertInto(int department, long long id, int priority, int age, std::string name,
+                                 std::string desc, long long arrival) {
+    // The shared index keeps an ID unique across all departments
+    if (homes.find(id) != nullptr) return false;
+
+    Department* target = &departments[department];
+    if (!target->queue->insert(id, priority, age, std::move(name), std::move(desc), arrival)) return false;
+    homes.insert(id, target, nullptr);
+    return true;
+}
+
+bool DepartmentQueue::peekAt(int department, TriageEntry& out) {
+    return departments[department].queue->peek(out);
+}
+
+bool DepartmentQueue::extractFrom(int department, TriageEntry& out) {
+    Department* source = &departments[department];
+    if (!source->queue->extractMin(out)) return false;
+
+    forget(out.id);
+    lastExtracted = source;
+    return true;
+}
+
+bool DepartmentQueue::mergeInto(int department, TriageQueue& other, long long& collidingId) {
+    // 1. The engine only sees its own IDs: check the other departments here,
+    // before anything moves, so a refused merge changes nothing
+    bool clash = false;
+    int incoming = other.getNumNodes();
+    long long* ids = new long long[incoming > 0 ? incoming : 1];
+    int n = 0;
+    other.forEachPatient([&](const TriageEntry& e) {
+        if (!clash && homes.find(e.id) != nullptr) {
+            clash = true;
+            collidingId = e.id;
+        }
+        ids[n++] = e.id;
+    });
+
+    // 2. O(1) splice into the department, then register the newcomers
+    Department* target = &departments[department];
+    bool merged = !clash && target->queue->merge(other, collidingId);
+    if (merged) {
+        homes.reserve(homes.size() + n);
+        for (int i = 0; i < n; i++) homes.insert(ids[i], target, nullptr);
+    }
+    delete[] ids;
+    return merged;
+}
+
+bool DepartmentQueue::transfer(long long id, int department) {
+    IdIndex<Department, void>::Entry* entry = homes.find(id);
+    if (entry == nullptr) return false;
+
+    Department* target = &departments[department];
+    if (entry->node == target) return true;
+
+    // Cut out of one engine, spliced into the other: no copy, no allocation
+    if (!entry->node->queue->transfer(id, *target->queue)) return false;
+    entry->node = target;
+    return true;
+}
+
+// ------------------------------------------
+// Persistence
+// ------------------------------------------
+
+bool DepartmentQueue::saveAssignments(const std::string& filename) {
+    // Same pattern as Snapshot::save(): complete .tmp file, then replaceFile()
+    std::string tempFilename = filename + ".tmp";
+    {
+        std::ofstream file(tempFilename);
+        if (!file.is_open()) return false;
+
+        for (int d = 1; d < count; d++) {
+            const std::string& name = departments[d].name;
+            departments[d].queue->forEachPatient([&file, &name](const TriageEntry& e) {
+                file << e.id << " " << name << "\n";
+            });
+        }
+        file.close();
+        if (file.fail()) {
+            remove(tempFilename.c_str());
+            return false;
+        }
+    }
+
+    return replaceFile(tempFilename, filename);
+}
+
+int DepartmentQueue::loadAssignments(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) return 0;
+
+    int moved = 0;
+    long long id;
+    std::string name;
+    while (file >> id >> name) {
+        int department = findDepartment(name);
+        if (department > 0 && departmentOf(id) >= 0 && transfer(id, department)) moved++;
+    }
+    return moved;
+}
+
+// ------------------------------------------
+// Across departments
+// ------------------------------------------
+
+int DepartmentQueue::mostUrgent() {
+    // O(#departments): only the heads can be the global minimum
+    int best = -1;
+    TriageEntry bestTop;
+    for (int d = 0; d < count; d++) {
+        TriageEntry top;
+        if (!departments[d].queue->peek(top)) continue;
+        if (best < 0 || urgentFirst(top, bestTop)) {
+            best = d;
+            bestTop = top;
+        }
+    }
+    return best;
+}
+
+bool DepartmentQueue::peekAny(TriageEntry& out) {
+    int best = mostUrgent();
+    return best >= 0 && peekAt(best, out);
+}
+
+bool DepartmentQueue::extractAny(TriageEntry& out, int& department) {
+    department = mostUrgent();
+    return department >= 0 && extractFrom(department, out);
+}
+
+int DepartmentQueue::visitMerged(int lo, int hi, int limit, PatientVisitor& visitor) {
+    // 1. Each department's own ordered walk, at most 'limit' patients each
+    TriageEntry* lists[MAX_DEPARTMENTS];
+    int sizes[MAX_DEPARTMENTS];
+    int next[MAX_DEPARTMENTS];
+    for (int d = 0; d < count; d++) {
+        TriageQueue* source = departments[d].queue;
+        int n = source->getNumNodes();
+        if (limit >= 0 && limit < n) n = limit;
+
+        TriageEntry* list = new TriageEntry[n > 0 ? n : 1];
+        int size = 0;
+        if (n > 0) {
+            if (limit >= 0) {
+                source->forEachTopK(n, [list, &size](const TriageEntry& e) { list[size++] = e; });
+            } else {
+                source->forEachInRange(lo, hi, [list, &size](const TriageEntry& e) { list[size++] = e; });
+            }
+        }
+        lists[d] = list;
+        sizes[d] = size;
+        next[d] = 0;
+    }
+
+    // 2. Merge them: the most urgent head goes next, as EXTRACT_ANY would pick it
+    int visited = 0;
+    while (limit < 0 || visited < limit) {
+        int best = -1;
+        for (int d = 0; d < count; d++) {
+            if (next[d] == sizes[d]) continue;
+            if (best < 0 || urgentFirst(lists[d][next[d]], lists[best][next[best]])) best = d;
+        }
+        if (best < 0) break;
+
+        visitor.visit(lists[best][next[best]++]);
+        visited++;
+    }
+
+    for (int d = 0; d < count; d++) delete[] lists[d];
+    return visited;
+}
+
+// ------------------------------------------
+// TriageQueue
+// ------------------------------------------
+
+bool DepartmentQueue::insert(long long id, int priority, int age, std::string name, std::string desc,
+                             long long arrival) {
+    return insertInto(0, id, priority, age, std::move(name), std::move(desc), arrival);
+}
+
+bool DepartmentQueue::peek(TriageEntry& out) {
+    return peekAt(0, out);
+}
+
+bool DepartmentQueue::extractMin(TriageEntry& out) {
+    return extractFrom(0, out);
+}
+
+PatientRecord* DepartmentQueue::getRecord(long long id) {
+    Department* home = homeOf(id);
+    if (home != nullptr) return home->queue->getRecord(id);
+
+    // The patient just handed out is only known to their old department
+    if (lastExtracted != nullptr) return lastExtracted->queue->getRecord(id);
+    return nullptr;
+}
+
+bool DepartmentQueue::find(long long id, TriageEntry& out) {
+    Department* home = homeOf(id);
+    return home != nullptr && home->queue->find(id, out);
+}
+
+bool DepartmentQueue::updatePriority(long long id, int newPriority) {
+    Department* home = homeOf(id);
+    return home != nullptr && home->queue->updatePriority(id, newPriority);
+}
+
+bool DepartmentQueue::removePatient(long long id) {
+    Department* home = homeOf(id);
+    if (home == nullptr || !home->queue->removePatient(id)) return false;
+    forget(id);
+    return true;
+}
+
+int DepartmentQueue::removePatients(const long long* ids, int idCount, bool* removedFlags) {
+    // 1. One department: its own batch removal as it is
+    if (count == 1) {
+        int removed = departments[0].queue->removePatients(ids, idCount, removedFlags);
+        for (int i = 0; i < idCount; i++) {
+            if (removedFlags[i]) forget(ids[i]);
+        }
+        return removed;
+    }
+
+    // 2. Otherwise one batch per department, so each keeps its single min rescan
+    int* homeIndex = new int[idCount > 0 ? idCount : 1];
+    long long* batch = new long long[idCount > 0 ? idCount : 1];
+    bool* batchFlags = new bool[idCount > 0 ? idCount : 1];
+    for (int i = 0; i < idCount; i++) {
+        homeIndex[i] = departmentOf(ids[i]);
+        removedFlags[i] = false;
+    }
+
+    int removed = 0;
+    for (int d = 0; d < count; d++) {
+        int n = 0;
+        for (int i = 0; i < idCount; i++) {
+            if (homeIndex[i] == d) batch[n++] = ids[i];
+        }
+        if (n == 0) continue;
+
+        removed += departments[d].queue->removePatients(batch, n, batchFlags);
+        int k = 0;
+        for (int i = 0; i < idCount; i++) {
+            if (homeIndex[i] != d) continue;
+            if (batchFlags[k]) {
+                removedFlags[i] = true;
+                forget(ids[i]);
+            }
+            k++;
+        }
+    }
+
+    delete[] homeIndex;
+    delete[] batch;
+    delete[] batchFlags;
+    return removed;
+}
+
+int DepartmentQueue::insertMany(PatientRow* rows, int rowCount) {
+    // 1. Rows whose ID is queued in another department are dropped up front
+    // (the engine would only catch its own duplicates)
+    int kept = 0;
+    for (int i = 0; i < rowCount; i++) {
+        if (homes.find(rows[i].id) != nullptr) continue;
+        if (kept != i) std::swap(rows[kept], rows[i]);
+        kept++;
+    }
+
+    // 2. One pass into department 0, then register whoever made it in
+    Department* target = &departments[0];
+    int added = target->queue->insertMany(rows, kept);
+    homes.reserve(homes.size() + added);
+    for (int i = 0; i < kept; i++) {
+        TriageEntry e;
+        if (homes.find(rows[i].id) == nullptr && target->queue->find(rows[i].id, e)) {
+            homes.insert(rows[i].id, target, nullptr);
+        }
+    }
+    return added;
+}
+
+bool DepartmentQueue::merge(TriageQueue& other, long long& collidingId) {
+    return mergeInto(0, other, collidingId);
+}
+
+bool DepartmentQueue::transfer(long long, TriageQueue&) {
+    // Between departments, use transfer(id, department)
+    return false;
+}
+
+void DepartmentQueue::adoptStorage(TriageQueue& other) {
+    departments[0].queue->adoptStorage(other);
+}
+
+void DepartmentQueue::reserve(int n) {
+    if (n <= 0) return;
+    departments[0].queue->reserve(n);
+    homes.reserve(homes.size() + n);
+}
+
+int DepartmentQueue::getNumNodes() {
+    int total = 0;
+    for (int d = 0; d < count; d++) total += departments[d].queue->getNumNodes();
+    return total;
+}
+
+PoolStats DepartmentQueue::getPoolStats() {
+    // Sums; the high-water mark is the sum of the departments' own peaks
+    PoolStats total = departments[0].queue->getPoolStats();
+    for (int d = 1; d < count; d++) {
+        PoolStats stats = departments[d].queue->getPoolStats();
+        total.live += stats.live;
+        total.highWater += stats.highWater;
+        total.capacity += stats.capacity;
+        total.slabs += stats.slabs;
+    }
+    return total;
+}
+
+bool DepartmentQueue::getHeapShape(HeapShape& out) {
+    if (!departments[0].queue->getHeapShape(out)) return false;
+
+    // Counters add up, maxima are the largest of any department
+    for (int d = 1; d < count; d++) {
+        HeapShape shape;
+        departments[d].queue->getHeapShape(shape);
+        out.consolidations += shape.consolidations;
+        out.rootsConsolidated += shape.rootsConsolidated;
+        out.lastRoots += shape.lastRoots;
+        if (shape.maxRoots > out.maxRoots) out.maxRoots = shape.maxRoots;
+        if (shape.maxDegree > out.maxDegree) out.maxDegree = shape.maxDegree;
+        out.cascades += shape.cascades;
+        out.cascadeCuts += shape.cascadeCuts;
+        if (shape.maxCascadeDepth > out.maxCascadeDepth) out.maxCascadeDepth = shape.maxCascadeDepth;
+        out.roots += shape.roots;
+        out.markedNodes += shape.markedNodes;
+    }
+    return true;
+}
+
+bool DepartmentQueue::saveToFile(std::string filename) {
+    if (count == 1) return departments[0].queue->saveToFile(filename);
+
+    std::ofstream file(filename);
+    if (!file.is_open()) return false;
+    forEachPatient([&file](const TriageEntry& e) { writePatient(file, e); });
+    file.close();
+    return true;
+}
+
+void DepartmentQueue::printAll(std::ostream& out) {
+    if (count == 1) {
+        departments[0].queue->printAll(out);
+        return;
+    }
+
+    // No flush here: the caller flushes once per command (or per batch)
+    auto line = [&out](const TriageEntry& e) {
+        out << "LIST_DATA ";
+        writePatient(out, e);
+    };
+    LambdaVisitor<decltype(line)> visitor(line);
+    visitMerged(MIN_PRIORITY, MAX_PRIORITY, -1, visitor);
+}
+
+void DepartmentQueue::visitPatients(PatientVisitor& visitor) {
+    for (int d = 0; d < count; d++) departments[d].queue->visitPatients(visitor);
+}
+
+int DepartmentQueue::visitTopK(int k, PatientVisitor& visitor) {
+    if (count == 1) return departments[0].queue->visitTopK(k, visitor);
+    if (k <= 0) return 0;
+    return visitMerged(MIN_PRIORITY, MAX_PRIORITY, k, visitor);
+}
+
+int DepartmentQueue::visitRange(int lo, int hi, PatientVisitor& visitor) {
+    if (count == 1) return departments[0].queue->visitRange(lo, hi, visitor);
+    return visitMerged(lo, hi, -1, visitor);
+}
+
+TriageQueue* DepartmentQueue::createEmpty() {
+    return departments[0].queue->createEmpty();
+}
+
+const char* DepartmentQueue::engineName() {
+    return departments[0].queue->engineName();
+}
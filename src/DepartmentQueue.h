@@ -0,0 +1,134 @@
+#ifndef DEPARTMENTQUEUE_H
+#define DEPARTMENTQUEUE_H
+
+#include <string>
+#include "TriageQueue.h"
+#include "PatientIndex.h"
+
+// A named queue of the emergency department (trauma, pediatrics, fast track, ...)
+struct Department {
+    std::string name;
+    TriageQueue* queue;     // Same engine for every department
+};
+
+// The whole ER: several department queues behind one TriageQueue.
+//
+// Department 0 ("main") is the default: insert(), peek(), extractMin() and
+// merge() go there, so a single-department setup behaves exactly like the
+// engine on its own. The read-only views (visitPatients, visitTopK,
+// visitRange, printAll, getNumNodes, ...) cover every department.
+//
+// One shared index maps every Patient ID to the department holding it, so
+// UPDATE and LEAVE go straight to the right queue and an ID can't be queued
+// twice across departments. transfer() moves a patient between departments
+// with the engines' own transfer(): the node is cut out of one queue and
+// spliced into the other, keeping ID, record and place in line.
+//
+// Across departments patients compare by (ESI, arrival); within a department
+// the engine's own order applies.
+class DepartmentQueue : public TriageQueue {
+public:
+    static const int MAX_DEPARTMENTS = 16;
+
+private:
+    Department departments[MAX_DEPARTMENTS];
+    int count;
+
+    // Patient ID -> the Department holding them (no record: the engine has it)
+    IdIndex<Department, void> homes;
+
+    // The department that handed out the last patient (getRecord() of an extracted patient)
+    Department* lastExtracted;
+
+    // Non-copyable: owns the department queues
+    DepartmentQueue(const DepartmentQueue&);
+    DepartmentQueue& operator=(const DepartmentQueue&);
+
+    Department* homeOf(long long id);
+    void forget(long long id) { homes.erase(id); }
+
+    // Most urgent department head by (ESI, arrival); -1 if every department is empty
+    int mostUrgent();
+
+    // Visits the patients of every department in EXTRACT_ANY order (a
+    // department-by-department merge of their own topK walks) until 'limit'
+    // patients were visited (-1 = all) or a priority above 'hi' comes up
+    int visitMerged(int lo, int hi, int limit, PatientVisitor& visitor);
+
+public:
+    // Takes ownership of 'main' (any engine), which becomes department 0 "main"
+    explicit DepartmentQueue(TriageQueue* main);
+    ~DepartmentQueue();
+
+    // Adds an empty department of the same engine. Names are 1-32 characters
+    // of [A-Za-z0-9_-] (they end up in file names). false = bad or repeated
+    // name, or MAX_DEPARTMENTS reached.
+    bool addDepartment(const std::string& name);
+
+    int departmentCount() { return count; }
+    const std::string& departmentName(int department) { return departments[department].name; }
+    TriageQueue& department(int department) { return *departments[department].queue; }
+    int findDepartment(const std::string& name);    // -1 = no such department
+    int departmentOf(long long id);                 // -1 = not queued
+
+    // --- Per-department operations ---
+    bool insertInto(int department, long long id, int priority, int age, std::string name, std::string desc,
+                    long long arrival = ARRIVAL_NOW);
+    bool peekAt(int department, TriageEntry& out);
+    bool extractFrom(int department, TriageEntry& out);
+
+    // Moves every patient of 'other' (same engine) into 'department'.
+    // Refused as a whole if one of their IDs is already queued anywhere.
+    bool mergeInto(int department, TriageQueue& other, long long& collidingId);
+
+    // Moves a queued patient to 'department' with the same ID, record and
+    // arrival, without copying them. Moving a patient to the department
+    // they are in succeeds and changes nothing. false = unknown ID.
+    bool transfer(long long id, int department);
+
+    // --- Persistence ---
+    // Snapshots hold every patient but not their department. This file adds
+    // it: one "<id> <department>" line per patient outside department 0,
+    // written to a .tmp file first and moved into place by replaceFile().
+    bool saveAssignments(const std::string& filename);
+
+    // Moves the listed patients to their departments. IDs that are not queued
+    // and departments that are not configured (any more) are skipped: those
+    // patients stay in department 0. Returns the number of patients moved.
+    int loadAssignments(const std::string& filename);
+
+    // --- Across departments: O(#departments) over the department heads ---
+    bool peekAny(TriageEntry& out);
+    bool extractAny(TriageEntry& out, int& department);
+
+    // --- TriageQueue (see the class comment for what goes where) ---
+    bool insert(long long id, int priority, int age, std::string name, std::string desc,
+                long long arrival = ARRIVAL_NOW);
+    bool peek(TriageEntry& out);
+    bool extractMin(TriageEntry& out);
+    PatientRecord* getRecord(long long id);
+    bool find(long long id, TriageEntry& out);
+
+    bool updatePriority(long long id, int newPriority);
+    bool removePatient(long long id);
+    int removePatients(const long long* ids, int count, bool* removedFlags);
+    int insertMany(PatientRow* rows, int count);
+    bool merge(TriageQueue& other, long long& collidingId);
+    bool transfer(long long id, TriageQueue& target);   // Departments only move through transfer(id, department)
+    void adoptStorage(TriageQueue& other);
+
+    void reserve(int n);
+    int getNumNodes();
+    PoolStats getPoolStats();
+    bool getHeapShape(HeapShape& out);
+    bool saveToFile(std::string filename);
+    void printAll(std::ostream& out);
+    void visitPatients(PatientVisitor& visitor);
+    int visitTopK(int k, PatientVisitor& visitor);
+    int visitRange(int lo, int hi, PatientVisitor& visitor);
+
+    TriageQueue* createEmpty();     // A plain queue of the departments' engine
+    const char* engineName();
+};
+
+#endif
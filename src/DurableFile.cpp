@@ -0,0 +1,71 @@
+#include "DurableFile.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ==========================================
+// DURABLE FILE REPLACEMENT
+// ==========================================
+
+#ifdef _WIN32
+
+bool syncFile(const std::string& filename) {
+    // FlushFileBuffers needs a handle with write access
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    bool ok = FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+    return ok;
+}
+
+// WRITE_THROUGH returns only once the move is on disk: no directory sync needed
+static bool renameOver(const std::string& from, const std::string& to) {
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+static bool syncDirectoryOf(const std::string&) { return true; }
+
+#else
+
+bool syncFile(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+// rename() replaces an existing target atomically
+static bool renameOver(const std::string& from, const std::string& to) {
+    return rename(from.c_str(), to.c_str()) == 0;
+}
+
+static bool syncDirectoryOf(const std::string& filename) {
+    size_t slash = filename.find_last_of('/');
+    std::string directory = (slash == std::string::npos) ? "." : filename.substr(0, slash + 1);
+
+    int fd = open(directory.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+#endif
+
+bool replaceFile(const std::string& tempFilename, const std::string& filename) {
+    // 1. The new contents reach the disk before any name points at them
+    if (!syncFile(tempFilename) || !renameOver(tempFilename, filename)) {
+        remove(tempFilename.c_str());
+        return false;
+    }
+
+    // 2. The rename is only durable once the directory entry is
+    return syncDirectoryOf(filename);
+}
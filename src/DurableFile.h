@@ -0,0 +1,23 @@
+#ifndef DURABLEFILE_H
+#define DURABLEFILE_H
+
+#include <string>
+
+// Crash-safe replacement of a whole file (snapshot, department assignments,
+// user database). Write the new contents to a temporary file, close it, then:
+//
+//   1. the temporary file is fsync'ed, so its bytes are on disk
+//   2. it is renamed over the old file in one step (rename() on POSIX,
+//      MoveFileEx with REPLACE_EXISTING on Windows): no moment without a file
+//   3. the directory is fsync'ed, so the rename itself survives a power cut
+//
+// At every point either the complete old file or the complete new one is
+// there. Anything that may only be dropped once the new file is safe (the
+// write-ahead log, after a snapshot) must wait for a true result.
+// On failure the temporary file is removed and the old file is untouched.
+bool replaceFile(const std::string& tempFilename, const std::string& filename);
+
+// Step 1 on its own: flushes a closed file's data to disk (false if it can't be opened)
+bool syncFile(const std::string& filename);
+
+#endif
@@ -5,47 +5,1065 @@
 #include <cmath>
 #include <string>
 #include <fstream>
+#include <functional>
+#include <utility>
+#include <type_traits>
 #include "Node.h"
+#include "NodePool.h"
+#include "PatientIndex.h"
+#include "Metrics.h"
+#include "SimdKeys.h"
 
 using namespace std;
 
-// Maximum Patient ID allowed. 
-const int MAX_PID = 10001; 
-
+// Header-only Fibonacci heap, reusable for any kind of queue.
+//
+//   Key      - what the heap orders by (patients: a packed PriorityKey)
+//   Payload  - the cold data stored next to each entry (patients: PatientRecord)
+//   Compare  - strict weak ordering; Compare()(a, b) == true means 'a' comes out first.
+//              std::less gives a min-heap, std::greater a max-heap.
+//
+// Entries are addressed by a 64-bit ID. Nodes and payloads come from slab
+// pools and are found through an IdIndex, so nothing is allocated per entry.
+//
+//   FibonacciHeap<int, BedRequest, std::greater<int> > beds;   // Highest score first
+//   beds.emplace(bedId, score, ward, std::move(notes));        // Payload built in place
+template <typename Key, typename Payload, typename Compare = std::less<Key> >
 class FibonacciHeap {
+public:
+    typedef HeapNode<Key> NodeType;
+
 private:
-    Node* minNode;
+    typedef typename IdIndex<NodeType, Payload>::Entry Entry;
+
+    NodeType* minNode;  // The entry that comes out first (by Compare)
     int numNodes;
+
+    // All node storage comes from here (no per-entry new/delete)
+    SlabPool<NodeType> pool;
+
+    // Cold payload data, kept out of the nodes
+    SlabPool<Payload> records;
+
+    // The last node returned by extractMin(). The heap still owns it;
+    // it (and its payload) goes back on the next extractMin() or on destruction.
+    NodeType* retired;
+    Payload* retiredRecord;
     
-    // REPLACEMENT FOR MAP: A raw array of pointers
-    // Index = Patient ID, Value = Pointer to Node
-    Node* nodeLookup[MAX_PID]; 
+    // ID -> Node + Payload (sparse, grows with the live entries)
+    IdIndex<NodeType, Payload> index;
+
+#if TRIAGE_METRICS
+    HeapShape shape;    // Shape counters, see getShape()
+#endif
+
+    // Empty class: costs no storage in practice, inlined into every compare
+    Compare comp;
+    bool before(const Key& a, const Key& b) const { return comp(a, b); }
+
+    // Root lists at least this long take consolidateWide()
+    static const int WIDE_ROOTS = 128;
 
     // Internal Helpers
-    void cut(Node* node, Node* parent);
-    void cascadingCut(Node* node);
-    void link(Node* y, Node* x);
-    void decreaseKey(Node* node, int newPriority); 
-    void _saveRecursive(Node* node, ofstream& file);
-    void _deleteAll(Node* node); //for the destructor
+    void cut(NodeType* node, NodeType* parent);
+    int cascadingCut(NodeType* node);       // Returns the number of ancestors cut
+    void noteCascade(int cuts);
+    void promoteChildren(NodeType* node);    // Moves all children of 'node' to the root list
+    void detachNode(NodeType* node);         // Out of the forest (still indexed), may leave minNode stale
+    void unlinkNode(NodeType* node);         // Lazy delete: detachNode() + storage back, no consolidate
+    void findNewMin();                       // O(#roots) scan, used after a lazy delete
+    void link(NodeType* y, NodeType* x);
+    void decreaseKey(NodeType* node, const Key& newKey); 
+    void increaseKey(NodeType* node, const Key& newKey); // In place: only re-roots what breaks heap order
     void consolidate(); 
+    void recycleRetired();
+
+    // consolidate() of a wide root list: gathered chunk by chunk into arrays
+    int consolidateWide(NodeType** A);                  // Returns the number of roots
+    void pairRun(NodeType** nodes, Key* keys, int m, NodeType** outNodes, Key* outKeys, int& outCount,
+                 unsigned char* bFirst, NodeType*& oddOne);
+    void carryInto(NodeType** A, NodeType* x);
+    void linkRoot(NodeType* y, NodeType* x);
+
+    // Candidate heap of forEachInKeyOrder(). Starts in the caller's 'local'
+    // array and moves to the free store (doubling) only if that fills up.
+    static void pushCandidate(NodeType**& heap, int& size, int& capacity, NodeType* node,
+                              const Compare& comp, NodeType** local);
+    static NodeType* popCandidate(NodeType** heap, int& size, const Compare& comp);
+    static void siftCandidate(NodeType** heap, int size, int i, NodeType* node, const Compare& comp);
+
+    // Non-copyable: owns the pools
+    FibonacciHeap(const FibonacciHeap&);
+    FibonacciHeap& operator=(const FibonacciHeap&);
 
 public:
     FibonacciHeap();
     ~FibonacciHeap();
 
-    void insert(int id, int priority, int age, string name, string desc);
-    Node* peek();
-    Node* extractMin();
+    // Inserts entry 'id' with 'key'; the payload is constructed in place from
+    // 'args' (pass strings with std::move to avoid copying them).
+    // Returns the new payload, or nullptr if the ID is already queued.
+    template <typename... Args>
+    Payload* emplace(long long id, const Key& key, Args&&... args);
+
+    NodeType* peek();
+    NodeType* extractMin(); // Returned node stays owned by the heap (do NOT delete it)
+    Payload* getPayload(long long id); // Payload of a queued (or just extracted) entry
+    NodeType* findNode(long long id);  // nullptr if the ID is not queued
     
-    void updatePriority(int id, int newPriority); 
-    void removePatient(int id);                   
-    void merge(FibonacciHeap& other);             
+    bool updateKey(long long id, const Key& newKey); // false = unknown ID
+    bool remove(long long id);                       // false = unknown ID
+
+    // Bulk removal: takes out every listed entry with a single min rescan.
+    // Returns how many were found and removed (removedFlags[i] says which).
+    int removeMany(const long long* ids, int count, bool* removedFlags);
+
+    // O(1) root-list splice plus O(min(n, k)) index work.
+    // Returns false (and changes nothing) if an ID exists in both heaps;
+    // the clashing ID is reported through 'collidingId'.
+    bool merge(FibonacciHeap& other, long long& collidingId);
+
+    // Moves entry 'id' into 'target' as it is: the node is cut out of this
+    // forest (a remove() that keeps the storage) and spliced into target's
+    // root list, key and payload untouched. Nothing is copied or allocated,
+    // and the node's memory stays in this heap's slabs: heaps that traded
+    // entries must be folded together with adoptStorage() before either one
+    // is destroyed. false = unknown ID, or already queued in 'target'.
+    bool transfer(long long id, FibonacciHeap& target);
+
+    // Takes over the slabs of 'other' (entries included, wherever they are
+    // queued now) so that 'other' can be destroyed. Its queued entries stay
+    // queued there; it must not be used for anything but destruction after this.
+    void adoptStorage(FibonacciHeap& other);
     
+    // Bulk load in one pass. For each element e of [first, last),
+    // fn(e, id, key) fills in the entry's ID and key (false = skip e), and the
+    // payload is move-constructed from e. Nodes come off one pre-sized run of
+    // slabs and are linked into binomial trees as they are created, so the
+    // heap gains at most log2(n) + 1 roots instead of n singletons and the
+    // first extractMin() has nothing big left to consolidate.
+    // An ID that is already queued, or repeats in the range, is skipped (the
+    // first one wins, as with emplace()). Returns the number of entries added.
+    template <typename It, typename Fn>
+    int buildFrom(It first, It last, Fn fn);
+
+    // Pre-sizes pools and index for 'n' more entries (bulk loading)
+    void reserve(int n);
+
     int getNumNodes();
-    void saveToFile(string filename);
-    void printAll();  // List all patients for GUI sync
+    PoolStats getPoolStats(); // Node pool occupancy and high-water mark
+
+    // Shape counters (zero when built with TRIAGE_METRICS=0), plus the
+    // current root-list length and marked-node count, counted now: O(n)
+    void getShape(HeapShape& out);
+
+    // Calls fn(NodeType*, Payload*) for every queued entry (index order)
+    template <typename Fn>
+    void forEach(Fn fn) {
+        int cap = index.getCapacity();
+        for (int i = 0; i < cap; i++) {
+            Entry* entry = index.slotAt(i);
+            if (entry->node != nullptr) fn(entry->node, entry->record);
+        }
+    }
+
+    // Calls fn(NodeType*, Payload*) root by root, parents before children.
+    // No recursion and no stack: the walk follows the parent pointers back up,
+    // so any tree shape costs O(n) time and O(1) memory. fn must not modify the heap.
+    template <typename Fn>
+    void forEachInHeapOrder(Fn fn);
+
+    // Calls fn(NodeType*, Payload*) in extraction order without touching the
+    // heap, until fn returns false. Best-first walk: a small binary heap of
+    // candidates starts with the roots, and each visited node adds its
+    // children. Visiting k entries costs O(r + k * degree * log) for r roots.
+    // Returns the number of calls made.
+    template <typename Fn>
+    int forEachInKeyOrder(Fn fn);
 
 };
 
-#endif
\ No newline at end of file
+// ==========================================
+// FIBONACCI HEAP IMPLEMENTATION
+// ==========================================
+
+template <typename Key, typename Payload, typename Compare>
+FibonacciHeap<Key, Payload, Compare>::FibonacciHeap() {
+    minNode = nullptr;
+    numNodes = 0;
+    retired = nullptr;
+    retiredRecord = nullptr;
+#if TRIAGE_METRICS
+    shape = HeapShape();
+#endif
+    // NOTE: The index, pool and record table allocate nothing until first use
+}
+
+template <typename Key, typename Payload, typename Compare>
+FibonacciHeap<Key, Payload, Compare>::~FibonacciHeap() {
+    recycleRetired();
+
+    // Bulk teardown, no tree walk: objects that need a destructor get it in one
+    // flat sweep of the index (patient nodes need none), then the pools free
+    // their slabs whole instead of returning every slot to a free list.
+    if (!std::is_trivially_destructible<Payload>::value || !std::is_trivially_destructible<NodeType>::value) {
+        forEach([this](NodeType* node, Payload* rec) {
+            records.destroy(rec);
+            pool.destroy(node);
+        });
+    }
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::recycleRetired() {
+    if (retired != nullptr) {
+        records.release(retiredRecord);
+        pool.release(retired);
+        retired = nullptr;
+        retiredRecord = nullptr;
+    }
+}
+
+template <typename Key, typename Payload, typename Compare>
+template <typename... Args>
+Payload* FibonacciHeap<Key, Payload, Compare>::emplace(long long id, const Key& key, Args&&... args) {
+    if (index.find(id) != nullptr) return nullptr; // ID already queued
+
+    NodeType* newNode = pool.acquire(id, key);
+    Payload* rec = records.acquire(std::forward<Args>(args)...);
+
+    if (minNode == nullptr) {
+        minNode = newNode;
+        minNode->left = minNode;
+        minNode->right = minNode;
+    } else {
+        minNode->addSibling(newNode);
+        if (before(newNode->key, minNode->key)) {
+            minNode = newNode;
+        }
+    }
+
+    index.insert(id, newNode, rec);
+    numNodes++;
+    return rec;
+}
+
+template <typename Key, typename Payload, typename Compare>
+typename FibonacciHeap<Key, Payload, Compare>::NodeType* FibonacciHeap<Key, Payload, Compare>::peek() {
+    return minNode;
+}
+
+template <typename Key, typename Payload, typename Compare>
+Payload* FibonacciHeap<Key, Payload, Compare>::getPayload(long long id) {
+    Entry* entry = index.find(id);
+    if (entry != nullptr) return entry->record;
+
+    // The entry just handed out by extractMin() is no longer indexed
+    if (retired != nullptr && retired->id == id) return retiredRecord;
+    return nullptr;
+}
+
+template <typename Key, typename Payload, typename Compare>
+typename FibonacciHeap<Key, Payload, Compare>::NodeType* FibonacciHeap<Key, Payload, Compare>::findNode(long long id) {
+    Entry* entry = index.find(id);
+    return (entry != nullptr) ? entry->node : nullptr;
+}
+
+template <typename Key, typename Payload, typename Compare>
+typename FibonacciHeap<Key, Payload, Compare>::NodeType* FibonacciHeap<Key, Payload, Compare>::extractMin() {
+    // The previously extracted node is no longer needed by the caller
+    recycleRetired();
+
+    NodeType* z = minNode;
+    if (z != nullptr) {
+        if (z->child != nullptr) {
+            NodeType* child = z->child;
+            NodeType* start = child;
+            do {
+                NodeType* nextChild = child->right;
+                minNode->addSibling(child); 
+                child->parent = nullptr;
+                child = nextChild;
+            } while (child != start);
+        }
+
+        retiredRecord = index.find(z->id)->record;
+        index.erase(z->id);
+
+        bool wasOnlyNode = (z == z->right);
+        NodeType* nextNode = z->right;  
+        
+        z->removeSelf();
+
+        if (wasOnlyNode) {
+            minNode = nullptr;
+        } else {
+            minNode = nextNode;  
+            consolidate();
+        }
+        numNodes--;
+        retired = z;
+    }
+    return z;
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::link(NodeType* y, NodeType* x) {
+    y->removeSelf(); // Remove y from root list
+    x->addChild(y);  // Make y a child of x
+    y->marked = false;
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::consolidate() {
+    // OPTIMIZATION: Use fixed size array on stack (No 'new', No 'vector')
+    // Max degree for N=1 Billion is < 50. Size 64 is infinite safety.
+    const int MAX_DEGREE = 64;
+    NodeType* A[MAX_DEGREE];
+    for (int i = 0; i < MAX_DEGREE; i++) A[i] = nullptr;
+
+    // 1. Count root nodes first to define the loop limit safely
+    //    (up to WIDE_ROOTS: consolidateWide() counts the rest as it goes)
+    int rootCount = 0;
+    if (minNode != nullptr) {
+        rootCount = 1;
+        NodeType* curr = minNode->right;
+        while (curr != minNode && rootCount < WIDE_ROOTS) {
+            rootCount++;
+            curr = curr->right;
+        }
+    }
+
+    // 2a. A surge of ADDs or a MERGE left a wide root list: the gathered path
+    bool wide = (rootCount >= WIDE_ROOTS);
+    if (wide) rootCount = consolidateWide(A);
+
+#if TRIAGE_METRICS
+    shape.consolidations++;
+    shape.rootsConsolidated += rootCount;
+    shape.lastRoots = rootCount;
+    if (rootCount > shape.maxRoots) shape.maxRoots = rootCount;
+#endif
+
+    if (!wide) {
+        // 2b. Iterate exactly 'rootCount' times
+        NodeType* x = minNode;
+        for (int i = 0; i < rootCount; i++) {
+            // CRITICAL: Save next pointer BEFORE linking/moving x
+            NodeType* nextNode = x->right;
+            
+            int d = x->degree;
+            // Safety clamp
+            if (d >= MAX_DEGREE) d = MAX_DEGREE - 1;
+
+            while (A[d] != nullptr) {
+                NodeType* y = A[d];
+                
+                // Ensure x is the parent (the one that comes first)
+                if (before(y->key, x->key)) {
+                    NodeType* temp = x;
+                    x = y;
+                    y = temp;
+                }
+                
+                link(y, x);
+                A[d] = nullptr;
+                d++;
+                if (d >= MAX_DEGREE) d = MAX_DEGREE - 1;
+            }
+            A[d] = x;
+            
+            // Move to the next node we saved earlier
+            x = nextNode;
+        }
+    }
+
+    // 3. Reconstruct Root List from Array A
+    minNode = nullptr;
+    for (int i = 0; i < MAX_DEGREE; i++) {
+        if (A[i] != nullptr) {
+#if TRIAGE_METRICS
+            if (i > shape.maxDegree) shape.maxDegree = i;
+#endif
+            if (minNode == nullptr) {
+                minNode = A[i];
+                minNode->left = minNode;
+                minNode->right = minNode;
+            } else {
+                minNode->addSibling(A[i]);
+                if (before(A[i]->key, minNode->key)) {
+                    minNode = A[i];
+                }
+            }
+        }
+    }
+}
+
+template <typename Key, typename Payload, typename Compare>
+int FibonacciHeap<Key, Payload, Compare>::consolidateWide(NodeType** A) {
+    // The loop in consolidate() walks the root list twice (count, then link)
+    // and decides every link with keys loaded through node pointers, one
+    // pair at a time. Here a single walk gathers the roots CHUNK at a time
+    // into arrays bucketed by degree, and each degree of the chunk is linked
+    // as a whole: neighbouring trees are paired up, so one PairwiseOrder
+    // call (vectorized for 64-bit keys) decides every pair from contiguous
+    // keys. The few trees a chunk leaves carry into A[] like single roots
+    // do. Chunks keep the work on nodes that are still in cache, and pairing
+    // neighbours builds trees of nodes that sit close together in the slabs.
+    //
+    // NOTE: The root list is not kept up to date while linking (see
+    // linkRoot()). That is safe because a link only touches roots already
+    // gathered, and A[] is the root list from then on.
+    const int MAX_DEGREE = 64;
+    const int CHUNK = 256;
+
+    NodeType* gathered[CHUNK];
+    NodeType* nodes[CHUNK];
+    Key keys[CHUNK];
+    NodeType* carryNodes[2][CHUNK / 2];
+    Key carryKeys[2][CHUNK / 2];
+    unsigned char bFirst[CHUNK / 2];
+
+    int rootCount = 0;
+    NodeType* curr = minNode;
+    do {
+        // 1. Gather the next (up to) CHUNK roots and count them per degree
+        int start[MAX_DEGREE + 1];
+        for (int d = 0; d <= MAX_DEGREE; d++) start[d] = 0;
+        int top = 0;
+        int m = 0;
+        do {
+            gathered[m++] = curr;
+            int d = (curr->degree < MAX_DEGREE) ? curr->degree : MAX_DEGREE - 1;
+            start[d + 1]++;
+            if (d > top) top = d;
+            curr = curr->right;
+        } while (m < CHUNK && curr != minNode);
+        rootCount += m;
+
+        // 2. Bucket them by degree (counting sort, stable):
+        //    degree d sits in [start[d], start[d + 1])
+        for (int d = 0; d < MAX_DEGREE; d++) start[d + 1] += start[d];
+        int fill[MAX_DEGREE];
+        for (int d = 0; d <= top; d++) fill[d] = start[d];
+        for (int i = 0; i < m; i++) {
+            NodeType* node = gathered[i];
+            int d = (node->degree < MAX_DEGREE) ? node->degree : MAX_DEGREE - 1;
+            nodes[fill[d]] = node;
+            keys[fill[d]] = node->key;
+            fill[d]++;
+        }
+
+        // 3. Link degree by degree. Degree d holds the roots gathered there
+        //    plus the trees that grew to d at the degree below (the carries,
+        //    alternating between two buffers); each link halves a level, so
+        //    no level makes more than CHUNK / 2 carries.
+        int carries = 0;
+        int current = 0;
+        for (int d = 0; d < MAX_DEGREE - 1 && (d <= top || carries > 0); d++) {
+            int next = 1 - current;
+            int made = 0;
+            NodeType* oddGathered = nullptr;
+            NodeType* oddCarried = nullptr;
+            if (d <= top) {
+                pairRun(nodes + start[d], keys + start[d], start[d + 1] - start[d],
+                        carryNodes[next], carryKeys[next], made, bFirst, oddGathered);
+            }
+            pairRun(carryNodes[current], carryKeys[current], carries,
+                    carryNodes[next], carryKeys[next], made, bFirst, oddCarried);
+
+            // At most one tree of degree d is left in each run: two make one more
+            // carry, one is the chunk's tree of degree d and goes on to A[]
+            if (oddGathered != nullptr && oddCarried != nullptr) {
+                NodeType* x = oddGathered;
+                NodeType* y = oddCarried;
+                if (before(y->key, x->key)) std::swap(x, y);
+                linkRoot(y, x);
+                carryNodes[next][made] = x;
+                carryKeys[next][made] = x->key;
+                made++;
+            } else if (oddGathered != nullptr) {
+                carryInto(A, oddGathered);
+            } else if (oddCarried != nullptr) {
+                carryInto(A, oddCarried);
+            }
+
+            carries = made;
+            current = next;
+        }
+
+        // Safety clamp, as in consolidate(): the last degree is never paired here
+        if (top == MAX_DEGREE - 1) {
+            for (int i = start[MAX_DEGREE - 1]; i < m; i++) carryInto(A, nodes[i]);
+        }
+        for (int i = 0; i < carries; i++) carryInto(A, carryNodes[current][i]);
+    } while (curr != minNode);
+
+    return rootCount;
+}
+
+// Pairs neighbouring trees of the run (2i with 2i + 1). The one that comes
+// first takes the other as its child and is appended to outNodes / outKeys
+// (one degree higher now). With an odd 'm' the last tree is left over in 'oddOne'.
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::pairRun(NodeType** nodes, Key* keys, int m,
+                                                   NodeType** outNodes, Key* outKeys, int& outCount,
+                                                   unsigned char* bFirst, NodeType*& oddOne) {
+    int pairs = m / 2;
+    PairwiseOrder<Key, Compare>::run(keys, pairs, bFirst, comp);
+
+    for (int i = 0; i < pairs; i++) {
+        int first = 2 * i + bFirst[i];
+        linkRoot(nodes[4 * i + 1 - first], nodes[first]);
+
+        outNodes[outCount] = nodes[first];
+        outKeys[outCount] = keys[first];
+        outCount++;
+    }
+
+    oddOne = (m & 1) ? nodes[m - 1] : nullptr;
+}
+
+// Adds one tree to A[] the way consolidate() does: linking with the tree of
+// the same degree already there, and again one degree up, until a slot is free
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::carryInto(NodeType** A, NodeType* x) {
+    const int MAX_DEGREE = 64;
+    int d = (x->degree < MAX_DEGREE) ? x->degree : MAX_DEGREE - 1;
+
+    while (A[d] != nullptr) {
+        NodeType* y = A[d];
+        if (before(y->key, x->key)) std::swap(x, y);
+        linkRoot(y, x);
+        A[d] = nullptr;
+        d++;
+        if (d >= MAX_DEGREE) d = MAX_DEGREE - 1;
+    }
+    A[d] = x;
+}
+
+// link() for consolidateWide(): no removeSelf(), the root list it would
+// patch is rebuilt as a whole, and addChild() sets every pointer of 'y' anyway
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::linkRoot(NodeType* y, NodeType* x) {
+    x->addChild(y);
+    y->marked = false;
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::decreaseKey(NodeType* node, const Key& newKey) {
+    node->key = newKey;
+    NodeType* parent = node->parent;
+
+    if (parent != nullptr && before(node->key, parent->key)) {
+        cut(node, parent);
+        noteCascade(cascadingCut(parent));
+    }
+
+    if (before(node->key, minNode->key)) {
+        minNode = node;
+    }
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::increaseKey(NodeType* node, const Key& newKey) {
+    // 1. Move the node to the root list, so its parent can't end up bigger than it
+    NodeType* parent = node->parent;
+    if (parent != nullptr) {
+        cut(node, parent);
+        noteCascade(cascadingCut(parent));
+    }
+
+    node->key = newKey;
+
+    // 2. Children that are now more urgent than the node become roots.
+    //    The others still satisfy heap order and stay where they are.
+    if (node->child != nullptr) {
+        NodeType* child = node->child;
+        int remaining = node->degree;
+        for (int i = 0; i < remaining; i++) {
+            NodeType* nextChild = child->right;
+            if (before(child->key, newKey)) {
+                node->removeChild(child);
+                minNode->addSibling(child);
+                child->parent = nullptr;
+            }
+            child = nextChild;
+        }
+    }
+
+    // 3. If the old minimum got less urgent, some other root may win now
+    if (node == minNode) findNewMin();
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::cut(NodeType* node, NodeType* parent) {
+    parent->removeChild(node);
+    minNode->addSibling(node);
+    node->parent = nullptr;
+    node->marked = false;
+}
+
+template <typename Key, typename Payload, typename Compare>
+int FibonacciHeap<Key, Payload, Compare>::cascadingCut(NodeType* node) {
+    // Climb while the ancestors are marked (a loop: the chain can be long)
+    int cuts = 0;
+    NodeType* parent = node->parent;
+    while (parent != nullptr) {
+        if (!node->marked) {
+            node->marked = true;
+            break;
+        }
+        cut(node, parent);
+        cuts++;
+        node = parent;
+        parent = node->parent;
+    }
+    return cuts;
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::noteCascade(int cuts) {
+#if TRIAGE_METRICS
+    if (cuts == 0) return;
+    shape.cascades++;
+    shape.cascadeCuts += cuts;
+    if (cuts > shape.maxCascadeDepth) shape.maxCascadeDepth = cuts;
+#else
+    (void)cuts;
+#endif
+}
+
+template <typename Key, typename Payload, typename Compare>
+bool FibonacciHeap<Key, Payload, Compare>::updateKey(long long id, const Key& newKey) {
+    Entry* entry = index.find(id);
+    if (entry == nullptr) return false;
+
+    NodeType* target = entry->node;
+    
+    if (before(target->key, newKey)) {
+        // Comes later now: same node, same payload, no allocation or string copy
+        increaseKey(target, newKey);
+    }
+    
+    else if (before(newKey, target->key)) {
+        decreaseKey(target, newKey);
+    }
+    return true;
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::promoteChildren(NodeType* node) {
+    if (node->child == nullptr) return;
+
+    NodeType* child = node->child;
+    NodeType* start = child;
+    do {
+        NodeType* nextChild = child->right;
+        minNode->addSibling(child);
+        child->parent = nullptr;
+        child->marked = false;
+        child = nextChild;
+    } while (child != start);
+
+    node->child = nullptr;
+    node->degree = 0;
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::detachNode(NodeType* node) {
+    // 1. Bring the node up to the root list (cascading cuts keep the bounds)
+    NodeType* parent = node->parent;
+    if (parent != nullptr) {
+        cut(node, parent);
+        noteCascade(cascadingCut(parent));
+    }
+
+    // 2. Its children simply become roots. No consolidate here:
+    //    that cleanup is left to the next real extractMin().
+    promoteChildren(node);
+
+    // 3. Keep minNode pointing at *some* root; findNewMin() fixes it up
+    if (node == minNode) {
+        minNode = (node->right == node) ? nullptr : node->right;
+    }
+    node->removeSelf();
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::unlinkNode(NodeType* node) {
+    detachNode(node);
+
+    // 4. Hand the storage back
+    Entry* entry = index.find(node->id);
+    records.release(entry->record);
+    index.erase(node->id);
+    pool.release(node);
+    numNodes--;
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::findNewMin() {
+    if (minNode == nullptr) return;
+
+    NodeType* best = minNode;
+    NodeType* curr = minNode->right;
+    while (curr != minNode) {
+        if (before(curr->key, best->key)) best = curr;
+        curr = curr->right;
+    }
+    minNode = best;
+}
+
+template <typename Key, typename Payload, typename Compare>
+bool FibonacciHeap<Key, Payload, Compare>::remove(long long id) {
+    Entry* entry = index.find(id);
+    if (entry == nullptr) return false;
+
+    // Lazy delete instead of decrease-to-INT_MIN + extractMin()
+    NodeType* target = entry->node;
+    bool wasMin = (target == minNode);
+    unlinkNode(target);
+
+    // Only removing the minimum needs a new one (a scan of the roots)
+    if (wasMin) findNewMin();
+    return true;
+}
+
+template <typename Key, typename Payload, typename Compare>
+int FibonacciHeap<Key, Payload, Compare>::removeMany(const long long* ids, int count, bool* removedFlags) {
+    int removed = 0;
+    bool minGone = false;
+
+    for (int i = 0; i < count; i++) {
+        Entry* entry = index.find(ids[i]);
+        removedFlags[i] = (entry != nullptr);
+        if (entry == nullptr) continue;
+
+        if (entry->node == minNode) minGone = true;
+        unlinkNode(entry->node);
+        removed++;
+    }
+
+    // One root scan for the whole batch
+    if (minGone) findNewMin();
+    return removed;
+}
+
+template <typename Key, typename Payload, typename Compare>
+bool FibonacciHeap<Key, Payload, Compare>::merge(FibonacciHeap& other, long long& collidingId) {
+    if (&other == this || other.minNode == nullptr) return true;
+
+    // Move the index first: it refuses the merge on duplicate IDs
+    if (!index.absorb(other.index, collidingId)) {
+        return false;
+    }
+
+    // The incoming nodes live in other's slabs: take ownership of them
+    other.recycleRetired();
+    pool.adopt(other.pool);
+    records.adopt(other.records);
+
+    if (minNode == nullptr) {
+        minNode = other.minNode;
+        numNodes = other.numNodes;
+    } else {
+        NodeType* myRight = minNode->right;
+        NodeType* otherLeft = other.minNode->left;
+
+        minNode->right = other.minNode;
+        other.minNode->left = minNode;
+
+        myRight->left = otherLeft;
+        otherLeft->right = myRight;
+
+        if (before(other.minNode->key, minNode->key)) {
+            minNode = other.minNode;
+        }
+        numNodes += other.numNodes;
+    }
+
+    other.minNode = nullptr;
+    other.numNodes = 0;
+    return true;
+}
+
+template <typename Key, typename Payload, typename Compare>
+bool FibonacciHeap<Key, Payload, Compare>::transfer(long long id, FibonacciHeap& target) {
+    if (&target == this) return false;
+    Entry* entry = index.find(id);
+    if (entry == nullptr || target.index.find(id) != nullptr) return false;
+
+    NodeType* node = entry->node;
+    Payload* rec = entry->record;
+
+    // 1. Out of this forest, exactly like remove(), but the storage is kept
+    bool wasMin = (node == minNode);
+    detachNode(node);
+    index.erase(id);
+    numNodes--;
+    if (wasMin) findNewMin();
+
+    // 2. Into target's root list as a lone root (children stayed behind as roots).
+    // It keeps its key, so it takes its place in target's order on the next consolidate.
+    node->marked = false;
+    if (target.minNode == nullptr) {
+        target.minNode = node;
+    } else {
+        target.minNode->addSibling(node);
+        if (before(node->key, target.minNode->key)) {
+            target.minNode = node;
+        }
+    }
+    target.index.insert(id, node, rec);
+    target.numNodes++;
+
+    // 3. Target now accounts for (and will recycle) the node and payload slots
+    pool.handOver(target.pool);
+    records.handOver(target.records);
+    return true;
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::adoptStorage(FibonacciHeap& other) {
+    if (&other == this) return;
+
+    // NOTE: Only the slabs move. Other's index and forest still describe its
+    // queued entries, so its destructor can run their destructors as usual
+    other.recycleRetired();
+    pool.adopt(other.pool);
+    records.adopt(other.records);
+}
+
+template <typename Key, typename Payload, typename Compare>
+template <typename It, typename Fn>
+int FibonacciHeap<Key, Payload, Compare>::buildFrom(It first, It last, Fn fn) {
+    // 1. Size the pools and the index once: no slab or rehash mid-build
+    reserve((int)(last - first));
+
+    // 2. Build the forest like a binary counter: trees[d] holds the pending
+    // tree of degree d, and every new node carries into it the way consolidate()
+    // links equal degrees. Each tree is a binomial tree, which keeps the degree
+    // bound consolidate() relies on, and it is built from nodes that are still
+    // in cache instead of by a walk over a million-node root list later.
+    const int MAX_DEGREE = 64;
+    NodeType* trees[MAX_DEGREE];
+    for (int i = 0; i < MAX_DEGREE; i++) trees[i] = nullptr;
+
+    int added = 0;
+    for (It it = first; it != last; ++it) {
+        long long id;
+        Key key;
+        if (!fn(*it, id, key)) continue;
+        if (index.find(id) != nullptr) continue; // Already queued, or earlier in the range
+
+        NodeType* x = pool.acquire(id, key);
+        Payload* rec = records.acquire(std::move(*it));
+        index.insert(id, x, rec);
+        added++;
+
+        int d = 0;
+        while (trees[d] != nullptr) {
+            NodeType* y = trees[d];
+            if (before(y->key, x->key)) {
+                NodeType* temp = x;
+                x = y;
+                y = temp;
+            }
+            link(y, x);
+            trees[d] = nullptr;
+            d++;
+        }
+        trees[d] = x;
+    }
+
+    // 3. Splice the finished trees into the root list
+    for (int i = 0; i < MAX_DEGREE; i++) {
+        if (trees[i] == nullptr) continue;
+        if (minNode == nullptr) {
+            minNode = trees[i];
+        } else {
+            minNode->addSibling(trees[i]);
+            if (before(trees[i]->key, minNode->key)) {
+                minNode = trees[i];
+            }
+        }
+    }
+    numNodes += added;
+    return added;
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::reserve(int n) {
+    if (n <= 0) return;
+    pool.reserve(n);
+    records.reserve(n);
+    index.reserve(index.size() + n);
+}
+
+template <typename Key, typename Payload, typename Compare>
+int FibonacciHeap<Key, Payload, Compare>::getNumNodes() {
+    return numNodes;
+}
+
+template <typename Key, typename Payload, typename Compare>
+PoolStats FibonacciHeap<Key, Payload, Compare>::getPoolStats() {
+    return pool.getStats();
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::getShape(HeapShape& out) {
+#if TRIAGE_METRICS
+    out = shape;
+#else
+    out = HeapShape();
+#endif
+
+    out.roots = 0;
+    if (minNode != nullptr) {
+        NodeType* curr = minNode;
+        do {
+            out.roots++;
+            curr = curr->right;
+        } while (curr != minNode);
+    }
+
+    out.markedNodes = 0;
+    forEach([&out](NodeType* node, Payload*) {
+        if (node->marked) out.markedNodes++;
+    });
+}
+
+template <typename Key, typename Payload, typename Compare>
+template <typename Fn>
+void FibonacciHeap<Key, Payload, Compare>::forEachInHeapOrder(Fn fn) {
+    NodeType* node = minNode;
+    while (node != nullptr) {
+        fn(node, index.find(node->id)->record);
+
+        // 1. Down to the first child
+        if (node->child != nullptr) {
+            node = node->child;
+            continue;
+        }
+
+        // 2. Across to the next sibling; once a sibling list is done, back up
+        // to the parent and try its next sibling. Each list starts at its
+        // parent's child pointer (the roots at minNode).
+        while (node != nullptr) {
+            NodeType* parent = node->parent;
+            NodeType* first = (parent != nullptr) ? parent->child : minNode;
+            if (node->right != first) {
+                node = node->right;
+                break;
+            }
+            node = parent;
+        }
+    }
+}
+
+template <typename Key, typename Payload, typename Compare>
+template <typename Fn>
+int FibonacciHeap<Key, Payload, Compare>::forEachInKeyOrder(Fn fn) {
+    if (minNode == nullptr) return 0;
+
+    // The first candidates live on the stack: short walks (TOPK) allocate nothing
+    const int LOCAL_CANDIDATES = 256;
+    NodeType* local[LOCAL_CANDIDATES];
+    int capacity = LOCAL_CANDIDATES;
+    int size = 0;
+    NodeType** candidates = local;
+
+    // 1. Every root may be next: seed the candidates with the root list. A long
+    // root list (many ADDs since the last EXTRACT) gets one array of its own,
+    // with room for the first children, instead of doubling its way there.
+    int roots = 0;
+    NodeType* curr = minNode;
+    do {
+        roots++;
+        curr = curr->right;
+    } while (curr != minNode);
+
+    if (roots > LOCAL_CANDIDATES) {
+        capacity = roots * 2;
+        candidates = new NodeType*[capacity];
+    }
+    do {
+        candidates[size++] = curr;
+        curr = curr->right;
+    } while (curr != minNode);
+
+    // 2. Heapify bottom-up: O(r) for r roots, not r sift-ups
+    for (int i = size / 2 - 1; i >= 0; i--) {
+        siftCandidate(candidates, size, i, candidates[i], comp);
+    }
+
+    // 3. Pop the best candidate; its children are the only new contenders
+    int visited = 0;
+    while (size > 0) {
+        NodeType* node = popCandidate(candidates, size, comp);
+        visited++;
+        if (!fn(node, index.find(node->id)->record)) break;
+
+        if (node->child != nullptr) {
+            NodeType* child = node->child;
+            do {
+                pushCandidate(candidates, size, capacity, child, comp, local);
+                child = child->right;
+            } while (child != node->child);
+        }
+    }
+
+    if (candidates != local) delete[] candidates;
+    return visited;
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::pushCandidate(NodeType**& heap, int& size, int& capacity,
+                                                         NodeType* node, const Compare& comp, NodeType** local) {
+    if (size == capacity) {
+        NodeType** bigger = new NodeType*[capacity * 2];
+        for (int i = 0; i < size; i++) bigger[i] = heap[i];
+        if (heap != local) delete[] heap;
+        heap = bigger;
+        capacity *= 2;
+    }
+
+    // Sift up
+    int i = size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!comp(node->key, heap[parent]->key)) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = node;
+}
+
+template <typename Key, typename Payload, typename Compare>
+typename FibonacciHeap<Key, Payload, Compare>::NodeType*
+FibonacciHeap<Key, Payload, Compare>::popCandidate(NodeType** heap, int& size, const Compare& comp) {
+    NodeType* top = heap[0];
+    NodeType* last = heap[--size];
+
+    // Sift the last element down from the top
+    if (size > 0) siftCandidate(heap, size, 0, last, comp);
+    return top;
+}
+
+template <typename Key, typename Payload, typename Compare>
+void FibonacciHeap<Key, Payload, Compare>::siftCandidate(NodeType** heap, int size, int i,
+                                                         NodeType* node, const Compare& comp) {
+    // Moves the better child up until 'node' fits at slot i
+    while (true) {
+        int child = 2 * i + 1;
+        if (child >= size) break;
+        if (child + 1 < size && comp(heap[child + 1]->key, heap[child]->key)) child++;
+        if (!comp(heap[child]->key, node->key)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = node;
+}
+
+#endif
@@ -0,0 +1,244 @@
+#include "FibonacciQueue.h"
+#include <fstream>
+#include <utility>
+
+// ==========================================
+// FIBONACCI QUEUE (TriageQueue ADAPTER)
+// ==========================================
+
+template <typename KeyPolicy>
+void FibonacciQueue<KeyPolicy>::fill(Node* node, TriageEntry& out) {
+    out.id = node->id;
+    out.priority = KeyPolicy::level(node->key);
+    out.arrival = KeyPolicy::arrival(node->key);
+    out.record = heap.getPayload(node->id);
+}
+
+template <typename KeyPolicy>
+void FibonacciQueue<KeyPolicy>::writePatient(std::ostream& out, Node* node, PatientRecord* rec) {
+    out << node->id << " "
+        << KeyPolicy::level(node->key) << " "
+        << rec->age << " "
+        << textField(rec->name) << " "
+        << textField(rec->description) << "\n";
+}
+
+template <typename KeyPolicy>
+bool FibonacciQueue<KeyPolicy>::insert(long long id, int priority, int age, std::string name, std::string desc,
+                                       long long arrival) {
+    if (!KeyPolicy::fits(priority)) return false;
+
+    // Explicit stamps (snapshot loads) are kept as they are; fresh ones
+    // never repeat, so two patients can't tie on the whole key
+    if (arrival == ARRIVAL_NOW) arrival = arrivalClock();
+    else noteArrival(arrival);
+
+    PriorityKey key = KeyPolicy::pack(priority, age, arrival);
+    return heap.emplace(id, key, id, age, std::move(name), std::move(desc)) != nullptr;
+}
+
+template <typename KeyPolicy>
+bool FibonacciQueue<KeyPolicy>::peek(TriageEntry& out) {
+    Node* node = heap.peek();
+    if (node == nullptr) return false;
+    fill(node, out);
+    return true;
+}
+
+template <typename KeyPolicy>
+bool FibonacciQueue<KeyPolicy>::extractMin(TriageEntry& out) {
+    Node* node = heap.extractMin();
+    if (node == nullptr) return false;
+    fill(node, out);
+    return true;
+}
+
+template <typename KeyPolicy>
+PatientRecord* FibonacciQueue<KeyPolicy>::getRecord(long long id) {
+    return heap.getPayload(id);
+}
+
+template <typename KeyPolicy>
+bool FibonacciQueue<KeyPolicy>::find(long long id, TriageEntry& out) {
+    Node* node = heap.findNode(id);
+    if (node == nullptr) return false;
+    fill(node, out);
+    return true;
+}
+
+template <typename KeyPolicy>
+bool FibonacciQueue<KeyPolicy>::updatePriority(long long id, int newPriority) {
+    if (!KeyPolicy::fits(newPriority)) return false;
+
+    // The patient keeps their place in line: only the ESI part of the key changes
+    Node* node = heap.findNode(id);
+    if (node == nullptr) return false;
+    return heap.updateKey(id, KeyPolicy::withLevel(node->key, newPriority));
+}
+
+template <typename KeyPolicy>
+bool FibonacciQueue<KeyPolicy>::removePatient(long long id) {
+    return heap.remove(id);
+}
+
+template <typename KeyPolicy>
+int FibonacciQueue<KeyPolicy>::removePatients(const long long* ids, int count, bool* removedFlags) {
+    return heap.removeMany(ids, count, removedFlags);
+}
+
+template <typename KeyPolicy>
+int FibonacciQueue<KeyPolicy>::insertMany(PatientRow* rows, int count) {
+    // Same key rules as insert(); the heap links the nodes as it creates them
+    return heap.buildFrom(rows, rows + count, [](PatientRow& row, long long& id, PriorityKey& key) {
+        if (!KeyPolicy::fits(row.priority)) return false;
+
+        long long arrival = row.arrival;
+        if (arrival == ARRIVAL_NOW) arrival = arrivalClock();
+        else noteArrival(arrival);
+
+        id = row.id;
+        key = KeyPolicy::pack(row.priority, row.age, arrival);
+        return true;
+    });
+}
+
+template <typename KeyPolicy>
+bool FibonacciQueue<KeyPolicy>::merge(TriageQueue& other, long long& collidingId) {
+    // MERGE always builds its scratch queue with createEmpty(), so this holds
+    FibonacciQueue* same = dynamic_cast<FibonacciQueue*>(&other); // Same policy too
+    if (same == nullptr) {
+        collidingId = -1;
+        return false;
+    }
+    return heap.merge(same->heap, collidingId);
+}
+
+template <typename KeyPolicy>
+bool FibonacciQueue<KeyPolicy>::transfer(long long id, TriageQueue& target) {
+    FibonacciQueue* same = dynamic_cast<FibonacciQueue*>(&target);
+    if (same == nullptr) return false;
+
+    // Cut here, spliced there: the key (and so the place in line) goes along
+    return heap.transfer(id, same->heap);
+}
+
+template <typename KeyPolicy>
+void FibonacciQueue<KeyPolicy>::adoptStorage(TriageQueue& other) {
+    FibonacciQueue* same = dynamic_cast<FibonacciQueue*>(&other);
+    if (same != nullptr) heap.adoptStorage(same->heap);
+}
+
+template <typename KeyPolicy>
+void FibonacciQueue<KeyPolicy>::reserve(int n) {
+    heap.reserve(n);
+}
+
+template <typename KeyPolicy>
+int FibonacciQueue<KeyPolicy>::getNumNodes() {
+    return heap.getNumNodes();
+}
+
+template <typename KeyPolicy>
+PoolStats FibonacciQueue<KeyPolicy>::getPoolStats() {
+    return heap.getPoolStats();
+}
+
+template <typename KeyPolicy>
+bool FibonacciQueue<KeyPolicy>::getHeapShape(HeapShape& out) {
+    heap.getShape(out);
+    return true;
+}
+
+template <typename KeyPolicy>
+bool FibonacciQueue<KeyPolicy>::saveToFile(std::string filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) return false;
+
+    heap.forEachInHeapOrder([&file](Node* node, PatientRecord* rec) {
+        writePatient(file, node, rec);
+    });
+    file.close();
+    return true;
+}
+
+template <typename KeyPolicy>
+void FibonacciQueue<KeyPolicy>::printAll(std::ostream& out) {
+    // Priority order, the order EXTRACT would hand them out (same as the bucket
+    // engine): an iterative best-first walk, O(n log n), the heap is not touched.
+    // No flush here: the caller flushes once per command (or per batch).
+    heap.forEachInKeyOrder([&out](Node* node, PatientRecord* rec) {
+        out << "LIST_DATA ";
+        writePatient(out, node, rec);
+        return true;
+    });
+}
+
+template <typename KeyPolicy>
+void FibonacciQueue<KeyPolicy>::visitPatients(PatientVisitor& visitor) {
+    heap.forEach([&visitor](Node* node, PatientRecord* rec) {
+        TriageEntry entry;
+        entry.id = node->id;
+        entry.priority = KeyPolicy::level(node->key);
+        entry.arrival = KeyPolicy::arrival(node->key);
+        entry.record = rec;
+        visitor.visit(entry);
+    });
+}
+
+template <typename KeyPolicy>
+int FibonacciQueue<KeyPolicy>::visitTopK(int k, PatientVisitor& visitor) {
+    if (k <= 0) return 0;
+
+    // Stops after the k-th patient: only O(k) nodes leave the candidate heap
+    int visited = 0;
+    heap.forEachInKeyOrder([&](Node* node, PatientRecord* rec) {
+        TriageEntry entry;
+        entry.id = node->id;
+        entry.priority = KeyPolicy::level(node->key);
+        entry.arrival = KeyPolicy::arrival(node->key);
+        entry.record = rec;
+        visitor.visit(entry);
+        return ++visited < k;
+    });
+    return visited;
+}
+
+template <typename KeyPolicy>
+int FibonacciQueue<KeyPolicy>::visitRange(int lo, int hi, PatientVisitor& visitor) {
+    // Keys sort by level first, so the walk ends at the first patient above 'hi'.
+    // Patients below 'lo' are passed over (their children may still be in range).
+    int visited = 0;
+    heap.forEachInKeyOrder([&](Node* node, PatientRecord* rec) {
+        int level = KeyPolicy::level(node->key);
+        if (level > hi) return false;
+        if (level < lo) return true;
+
+        TriageEntry entry;
+        entry.id = node->id;
+        entry.priority = level;
+        entry.arrival = KeyPolicy::arrival(node->key);
+        entry.record = rec;
+        visitor.visit(entry);
+        visited++;
+        return true;
+    });
+    return visited;
+}
+
+template <typename KeyPolicy>
+TriageQueue* FibonacciQueue<KeyPolicy>::createEmpty() {
+    return new FibonacciQueue<KeyPolicy>();
+}
+
+template <typename KeyPolicy>
+const char* FibonacciQueue<KeyPolicy>::engineName() {
+    return "fib";
+}
+
+template <>
+const char* FibonacciQueue<EsiAgeArrivalKey>::engineName() {
+    return "fib-age";
+}
+
+template class FibonacciQueue<EsiArrivalKey>;
+template class FibonacciQueue<EsiAgeArrivalKey>;
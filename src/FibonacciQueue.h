@@ -0,0 +1,50 @@
+#ifndef FIBONACCIQUEUE_H
+#define FIBONACCIQUEUE_H
+
+#include "TriageQueue.h"
+#include "FibHeap.h"
+
+// TriageQueue engine backed by the generic FibonacciHeap.
+// KeyPolicy packs (ESI, age, arrival) into the heap's PriorityKey, so the
+// heap itself orders with a plain std::less on one 64-bit integer
+// (instantiated in FibonacciQueue.cpp for the policies in PriorityKey.h).
+template <typename KeyPolicy>
+class FibonacciQueue : public TriageQueue {
+private:
+    typedef FibonacciHeap<PriorityKey, PatientRecord> Heap;
+    Heap heap;
+
+    void fill(Node* node, TriageEntry& out);
+    static void writePatient(std::ostream& out, Node* node, PatientRecord* rec);
+
+public:
+    bool insert(long long id, int priority, int age, std::string name, std::string desc,
+                long long arrival = ARRIVAL_NOW);
+    bool peek(TriageEntry& out);
+    bool extractMin(TriageEntry& out);
+    PatientRecord* getRecord(long long id);
+    bool find(long long id, TriageEntry& out);
+
+    bool updatePriority(long long id, int newPriority);
+    bool removePatient(long long id);
+    int removePatients(const long long* ids, int count, bool* removedFlags);
+    int insertMany(PatientRow* rows, int count);
+    bool merge(TriageQueue& other, long long& collidingId);
+    bool transfer(long long id, TriageQueue& target);
+    void adoptStorage(TriageQueue& other);
+
+    void reserve(int n);
+    int getNumNodes();
+    PoolStats getPoolStats();
+    bool getHeapShape(HeapShape& out);
+    bool saveToFile(std::string filename);
+    void printAll(std::ostream& out);
+    void visitPatients(PatientVisitor& visitor);
+    int visitTopK(int k, PatientVisitor& visitor);
+    int visitRange(int lo, int hi, PatientVisitor& visitor);
+
+    TriageQueue* createEmpty();
+    const char* engineName();
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "Kdf.h"
+#include <cstring>
+
+// ==========================================
+// SHA-256
+// ==========================================
+
+static const uint32_t ROUND_CONSTANTS[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+Sha256::Sha256() {
+    state[0] = 0x6a09e667; state[1] = 0xbb67ae85; state[2] = 0x3c6ef372; state[3] = 0xa54ff53a;
+    state[4] = 0x510e527f; state[5] = 0x9b05688c; state[6] = 0x1f83d9ab; state[7] = 0x5be0cd19;
+    blockUsed = 0;
+    totalBytes = 0;
+}
+
+void Sha256::compress(const unsigned char* chunk) {
+    // 1. Message schedule (big-endian words)
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)chunk[i * 4] << 24) | ((uint32_t)chunk[i * 4 + 1] << 16) |
+               ((uint32_t)chunk[i * 4 + 2] << 8) | (uint32_t)chunk[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    // 2. 64 rounds
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t choose = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + choose + ROUND_CONSTANTS[i] + w[i];
+        uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + majority;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void Sha256::update(const void* data, size_t length) {
+    const unsigned char* p = (const unsigned char*)data;
+    totalBytes += length;
+
+    // Top up a partial block first, then compress whole blocks in place
+    if (blockUsed > 0) {
+        size_t take = 64 - blockUsed;
+        if (take > length) take = length;
+        memcpy(block + blockUsed, p, take);
+        blockUsed += take;
+        p += take;
+        length -= take;
+        if (blockUsed < 64) return;
+        compress(block);
+        blockUsed = 0;
+    }
+    while (length >= 64) {
+        compress(p);
+        p += 64;
+        length -= 64;
+    }
+    memcpy(block, p, length);
+    blockUsed = length;
+}
+
+void Sha256::finish(unsigned char digest[SHA256_BYTES]) {
+    uint64_t bits = totalBytes * 8;
+
+    // 0x80, zeros up to 56 mod 64, then the bit length (big-endian)
+    block[blockUsed++] = 0x80;
+    if (blockUsed > 56) {
+        memset(block + blockUsed, 0, 64 - blockUsed);
+        compress(block);
+        blockUsed = 0;
+    }
+    memset(block + blockUsed, 0, 56 - blockUsed);
+    for (int i = 0; i < 8; i++) block[56 + i] = (unsigned char)(bits >> (56 - 8 * i));
+    compress(block);
+
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (unsigned char)(state[i] >> 24);
+        digest[i * 4 + 1] = (unsigned char)(state[i] >> 16);
+        digest[i * 4 + 2] = (unsigned char)(state[i] >> 8);
+        digest[i * 4 + 3] = (unsigned char)state[i];
+    }
+}
+
+// ==========================================
+// HMAC AND PBKDF2
+// ==========================================
+
+// Inner and outer contexts with the padded key already absorbed
+static void hmacKeyed(const void* key, size_t keyLength, Sha256& inner, Sha256& outer) {
+    unsigned char padded[64];
+    memset(padded, 0, sizeof(padded));
+    if (keyLength > 64) {
+        Sha256 shortened;
+        shortened.update(key, keyLength);
+        shortened.finish(padded);
+    } else {
+        memcpy(padded, key, keyLength);
+    }
+
+    unsigned char pad[64];
+    for (int i = 0; i < 64; i++) pad[i] = padded[i] ^ 0x36;
+    inner.update(pad, 64);
+    for (int i = 0; i < 64; i++) pad[i] = padded[i] ^ 0x5c;
+    outer.update(pad, 64);
+}
+
+void hmacSha256(const void* key, size_t keyLength, const void* data, size_t length,
+                unsigned char digest[SHA256_BYTES]) {
+    Sha256 inner, outer;
+    hmacKeyed(key, keyLength, inner, outer);
+
+    unsigned char innerDigest[SHA256_BYTES];
+    inner.update(data, length);
+    inner.finish(innerDigest);
+    outer.update(innerDigest, SHA256_BYTES);
+    outer.finish(digest);
+}
+
+void pbkdf2Sha256(const std::string& password, const unsigned char* salt, size_t saltLength,
+                  int iterations, unsigned char* out, size_t outLength) {
+    // OPTIMIZATION: The key (password) is the same for every HMAC, so its
+    // padded blocks are absorbed once and each iteration starts from a copy
+    Sha256 keyedInner, keyedOuter;
+    hmacKeyed(password.data(), password.size(), keyedInner, keyedOuter);
+
+    for (uint32_t blockIndex = 1; outLength > 0; blockIndex++) {
+        // U1 = HMAC(password, salt || INT(blockIndex))
+        unsigned char counter[4] = {
+            (unsigned char)(blockIndex >> 24), (unsigned char)(blockIndex >> 16),
+            (unsigned char)(blockIndex >> 8), (unsigned char)blockIndex
+        };
+        unsigned char u[SHA256_BYTES];
+        Sha256 inner = keyedInner;
+        inner.update(salt, saltLength);
+        inner.update(counter, 4);
+        inner.finish(u);
+        Sha256 outer = keyedOuter;
+        outer.update(u, SHA256_BYTES);
+        outer.finish(u);
+
+        // T = U1 ^ U2 ^ ... ^ Uc
+        unsigned char t[SHA256_BYTES];
+        memcpy(t, u, SHA256_BYTES);
+        for (int i = 1; i < iterations; i++) {
+            inner = keyedInner;
+            inner.update(u, SHA256_BYTES);
+            inner.finish(u);
+            outer = keyedOuter;
+            outer.update(u, SHA256_BYTES);
+            outer.finish(u);
+            for (int j = 0; j < SHA256_BYTES; j++) t[j] ^= u[j];
+        }
+
+        size_t take = (outLength < (size_t)SHA256_BYTES) ? outLength : (size_t)SHA256_BYTES;
+        memcpy(out, t, take);
+        out += take;
+        outLength -= take;
+    }
+}
+
+bool equalBytes(const unsigned char* a, const unsigned char* b, size_t length) {
+    unsigned char diff = 0;
+    for (size_t i = 0; i < length; i++) diff |= a[i] ^ b[i];
+    return diff == 0;
+}
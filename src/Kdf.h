@@ -0,0 +1,44 @@
+#ifndef KDF_H
+#define KDF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Password hashing primitives for AuthSystem: SHA-256 (FIPS 180-4),
+// HMAC-SHA256 (RFC 2104) and PBKDF2-HMAC-SHA256 (RFC 8018).
+// Self-contained so the backend needs no crypto library.
+
+const int SHA256_BYTES = 32;
+
+// Incremental SHA-256. Copyable on purpose: PBKDF2 keeps the keyed inner and
+// outer HMAC states and copies them for every iteration.
+class Sha256 {
+private:
+    uint32_t state[8];
+    unsigned char block[64];
+    size_t blockUsed;       // Bytes waiting in 'block'
+    uint64_t totalBytes;
+
+    void compress(const unsigned char* chunk);
+
+public:
+    Sha256();
+
+    void update(const void* data, size_t length);
+    void finish(unsigned char digest[SHA256_BYTES]); // The context is spent afterwards
+};
+
+void hmacSha256(const void* key, size_t keyLength, const void* data, size_t length,
+                unsigned char digest[SHA256_BYTES]);
+
+// Derives 'outLength' bytes from 'password' and 'salt'. Cost is linear in
+// 'iterations' (two SHA-256 compressions each), the knob tuned with
+// bench/AuthBench.cpp.
+void pbkdf2Sha256(const std::string& password, const unsigned char* salt, size_t saltLength,
+                  int iterations, unsigned char* out, size_t outLength);
+
+// Compares in time independent of where the bytes differ
+bool equalBytes(const unsigned char* a, const unsigned char* b, size_t length);
+
+#endif
@@ -0,0 +1,205 @@
+#include "Manifest.h"
+#include "MappedFile.h"
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+// ==========================================
+// MANIFEST PARSING
+// ==========================================
+
+static const size_t MIN_CHUNK = 256 * 1024;    // Below this a thread costs more than it saves
+static const int MAX_WORKERS = 8;
+
+// One worker's share of the file
+struct ManifestChunk {
+    const char* begin;
+    const char* end;
+    long long firstLine;    // Row number of the chunk's first line in the whole file
+    long long lines;
+    TriageQueue* queue;     // Private sub-queue (the target itself when there is one chunk)
+    long long maxId;
+};
+
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Next whitespace-separated token of the line [p, end)
+static bool nextToken(const char*& p, const char* end, const char*& token, size_t& length) {
+    while (p < end && isBlank(*p)) p++;
+    if (p == end) return false;
+
+    token = p;
+    while (p < end && !isBlank(*p)) p++;
+    length = (size_t)(p - token);
+    return true;
+}
+
+// Locale-free integer parse of a whole token. false = not a number, or
+// outside the range of long long (the digits are summed unsigned, so an
+// overlong token is rejected instead of wrapping).
+static bool parseNumber(const char* token, size_t length, long long& out) {
+    size_t i = 0;
+    bool negative = false;
+    if (length > 0 && (token[0] == '-' || token[0] == '+')) {
+        negative = (token[0] == '-');
+        i = 1;
+    }
+    if (i == length) return false;
+
+    // LLONG_MIN has no positive counterpart: allow one more when negative
+    unsigned long long limit = (unsigned long long)LLONG_MAX + (negative ? 1 : 0);
+    unsigned long long value = 0;
+    for (; i < length; i++) {
+        if (token[i] < '0' || token[i] > '9') return false;
+        unsigned digit = (unsigned)(token[i] - '0');
+        if (value > (limit - digit) / 10) return false;
+        value = value * 10 + digit;
+    }
+    out = negative ? (long long)(0 - value) : (long long)value;
+    return true;
+}
+
+static void countLines(ManifestChunk& chunk) {
+    long long lines = 0;
+    const char* p = chunk.begin;
+    while (p < chunk.end) {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(chunk.end - p));
+        lines++;
+        if (newline == nullptr) break;
+        p = newline + 1;
+    }
+    chunk.lines = lines;
+}
+
+static void parseChunk(ManifestChunk& chunk, long long firstArrival) {
+    long long line = chunk.firstLine;
+    const char* p = chunk.begin;
+
+    // At most one row per line; the queue is built from them in one pass at the end
+    PatientRow* rows = new PatientRow[chunk.lines];
+    int count = 0;
+
+    while (p < chunk.end) {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(chunk.end - p));
+        const char* lineEnd = (newline != nullptr) ? newline : chunk.end;
+
+        // [ID] [PRIORITY] [AGE] [NAME] [DESC] (anything after DESC is ignored)
+        const char* tokens[5];
+        size_t lengths[5];
+        int found = 0;
+        while (found < 5 && nextToken(p, lineEnd, tokens[found], lengths[found])) found++;
+
+        // Ranges are checked on the parsed values, before anything is narrowed to int.
+        // IDs are positive and leave room for the next auto-generated one (maxId + 1).
+        long long id, priority, age;
+        if (found == 5 && parseNumber(tokens[0], lengths[0], id) &&
+            parseNumber(tokens[1], lengths[1], priority) && parseNumber(tokens[2], lengths[2], age) &&
+            id >= 1 && id < LLONG_MAX && priority >= MIN_PRIORITY && priority <= MAX_PRIORITY && age >= INT_MIN && age <= INT_MAX &&
+            lengths[3] <= (size_t)MAX_TEXT_LENGTH && lengths[4] <= (size_t)MAX_TEXT_LENGTH) {
+            PatientRow& row = rows[count++];
+            row.id = id;
+            row.priority = (int)priority;
+            row.age = (int)age;
+            row.arrival = firstArrival + line; // Row order is arrival order, whichever thread parses it
+            row.name.assign(tokens[3], lengths[3]);
+            row.description.assign(tokens[4], lengths[4]);
+
+            // Every row that gets here is inserted, except a repeat of an ID
+            // already taken, so only rows that were admitted raise maxId
+            if (id > chunk.maxId) chunk.maxId = id;
+        }
+
+        line++;
+        p = lineEnd + 1;
+    }
+
+    chunk.queue->insertMany(rows, count);
+    delete[] rows;
+}
+
+bool Manifest::load(TriageQueue& target, long long& maxId, const std::string& filename, int workers) {
+    MappedFile file;
+    if (!file.open(filename)) return false;
+    if (file.size() == 0) return true;
+
+    const char* data = file.data();
+    size_t size = file.size();
+
+    // 1. How many chunks: one per MIN_CHUNK bytes, at most one per core
+    if (workers <= 0) {
+        workers = (int)std::thread::hardware_concurrency();
+        if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+    }
+    int chunks = (int)(size / MIN_CHUNK);
+    if (chunks > workers) chunks = workers;
+    if (chunks < 1) chunks = 1;
+
+    // 2. Cut at line boundaries (a cut point moves forward to the next line start)
+    ManifestChunk* parts = new ManifestChunk[chunks];
+    const char* start = data;
+    for (int i = 0; i < chunks; i++) {
+        const char* end = data + size;
+        if (i < chunks - 1) {
+            end = data + size / chunks * (i + 1);
+            if (end < start) end = start;
+            const char* newline = (const char*)memchr(end, '\n', (size_t)(data + size - end));
+            end = (newline != nullptr) ? newline + 1 : data + size;
+        }
+        parts[i].begin = start;
+        parts[i].end = end;
+        parts[i].maxId = 0;
+        parts[i].queue = (chunks == 1) ? &target : target.createEmpty();
+        start = end;
+    }
+
+    std::thread* threads = (chunks > 1) ? new std::thread[chunks] : nullptr;
+
+    // 3. Row numbers: count each chunk's lines, then prefix sums
+    if (threads != nullptr) {
+        for (int i = 0; i < chunks; i++) threads[i] = std::thread(countLines, std::ref(parts[i]));
+        for (int i = 0; i < chunks; i++) threads[i].join();
+    } else {
+        countLines(parts[0]);
+    }
+    long long totalLines = 0;
+    for (int i = 0; i < chunks; i++) {
+        parts[i].firstLine = totalLines;
+        totalLines += parts[i].lines;
+    }
+
+    // Reserve one arrival stamp per row up front, so the workers never race on the clock
+    long long firstArrival = arrivalClock();
+    noteArrival(firstArrival + totalLines);
+
+    // 4. Parse every chunk into its own sub-queue
+    if (threads != nullptr) {
+        for (int i = 0; i < chunks; i++) {
+            threads[i] = std::thread(parseChunk, std::ref(parts[i]), firstArrival);
+        }
+        for (int i = 0; i < chunks; i++) threads[i].join();
+        delete[] threads;
+    } else {
+        parseChunk(parts[0], firstArrival);
+    }
+
+    // 5. Splice the sub-queues together in file order
+    for (int i = 0; i < chunks; i++) {
+        if (parts[i].maxId > maxId) maxId = parts[i].maxId;
+        if (parts[i].queue == &target) continue;
+
+        long long collidingId;
+        if (!target.merge(*parts[i].queue, collidingId)) {
+            // An ID repeats across chunks: insert one by one, the earlier row wins
+            parts[i].queue->forEachPatient([&target](const TriageEntry& e) {
+                target.insert(e.id, e.priority, e.record->age, e.record->name,
+                              e.record->description, e.arrival);
+            });
+        }
+        delete parts[i].queue;
+    }
+    delete[] parts;
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include <string>
+#include "TriageQueue.h"
+
+// Text patient lists: one "[ID] [PRIORITY] [AGE] [NAME] [DESC]" row per line.
+// This is the legacy patients_data.txt, the EXPORT output and the ambulance
+// manifests read by MERGE.
+//
+// The file is memory-mapped and parsed in place. Large files are cut into
+// chunks at line boundaries; each worker thread parses one chunk into a
+// private sub-queue, and the sub-queues are then spliced into the target
+// with merge() (O(1) root-list splice for the heap engines). Arrival stamps
+// follow the row order of the file, exactly as if it had been read serially.
+class Manifest {
+public:
+    // Reads 'filename' into 'target'; 'maxId' is raised to the highest ID inserted.
+    // Rows that fail to parse (a number out of range, an ID below 1, a
+    // priority outside 1-10 or a name or description over MAX_TEXT_LENGTH)
+    // are skipped; an ID seen twice keeps its first row.
+    // 'workers' = 0 picks a thread count from the file size and the machine.
+    // Returns false if the file cannot be opened.
+    static bool load(TriageQueue& target, long long& maxId, const std::string& filename, int workers = 0);
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ==========================================
+// MEMORY MAPPED FILE IMPLEMENTATION
+// ==========================================
+
+MappedFile::MappedFile() {
+    bytes = nullptr;
+    length = 0;
+#ifdef _WIN32
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = nullptr;
+#else
+    fd = -1;
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    length = (size_t)fileSize.QuadPart;
+
+    // An empty file cannot be mapped, but it is still a valid (empty) file
+    if (length == 0) return true;
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        return false;
+    }
+    mappingHandle = mapping;
+
+    bytes = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (bytes == nullptr) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes != nullptr) UnmapViewOfFile(bytes);
+    if (mappingHandle != nullptr) CloseHandle((HANDLE)mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle((HANDLE)fileHandle);
+
+    bytes = nullptr;
+    length = 0;
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close();
+        return false;
+    }
+    length = (size_t)info.st_size;
+
+    // An empty file cannot be mapped, but it is still a valid (empty) file
+    if (length == 0) return true;
+
+    void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        close();
+        return false;
+    }
+    bytes = (const char*)addr;
+
+    // We read the file front to back exactly once
+    madvise(addr, length, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes != nullptr) munmap((void*)bytes, length);
+    if (fd >= 0) ::close(fd);
+
+    bytes = nullptr;
+    length = 0;
+    fd = -1;
+}
+
+#endif
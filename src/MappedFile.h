@@ -0,0 +1,37 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file.
+// Uses mmap on POSIX and MapViewOfFile on Windows; the bytes can be
+// parsed in place without copying them into a std::string first.
+class MappedFile {
+private:
+    const char* bytes;
+    size_t length;
+
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+
+    // Non-copyable: the mapping has exactly one owner
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const std::string& filename); // false if missing or unreadable
+    void close();
+
+    const char* data() { return bytes; }
+    size_t size() { return length; }
+};
+
+#endif
@@ -0,0 +1,135 @@
+#include "Metrics.h"
+#include <cstdio>
+
+// ==========================================
+// COMMAND LATENCY HISTOGRAMS
+// ==========================================
+
+// Command names, in histogram order; the last histogram collects everything else
+static const char* const COMMAND_NAMES[CommandMetrics::COMMANDS - 1] = {
+    "LOGIN", "CHANGE_PASS", "EXIT", "PING",
+    "ADD", "EXTRACT", "PEEK", "UPDATE", "LEAVE", "LEAVE_MANY",
+    "TOPK", "RANGE", "STATS", "POOL", "LIST", "SUBSCRIBE", "CHANGES",
+    "MERGE", "EXPORT", "METRICS", "SNAPSHOT", "UNDO", "REDO", "AUDIT",
+    "QUEUES", "ADD_TO", "EXTRACT_FROM", "EXTRACT_ANY", "TRANSFER"
+};
+
+// Bucket upper bounds in nanoseconds: 5 us to 1 s
+static const long long BUCKET_BOUNDS[CommandMetrics::BUCKETS] = {
+    5000, 10000, 25000, 50000, 100000, 250000, 500000,
+    1000000, 2500000, 5000000, 10000000, 25000000, 50000000,
+    100000000, 250000000, 1000000000
+};
+
+CommandMetrics::CommandMetrics() {
+    histograms = new Histogram[COMMANDS];
+    for (int c = 0; c < COMMANDS; c++) {
+        for (int b = 0; b <= BUCKETS; b++) histograms[c].counts[b].store(0, std::memory_order_relaxed);
+        histograms[c].sumNanos.store(0, std::memory_order_relaxed);
+    }
+}
+
+CommandMetrics::~CommandMetrics() {
+    delete[] histograms;
+}
+
+int CommandMetrics::commandIndex(const std::string& command) {
+    for (int c = 0; c < COMMANDS - 1; c++) {
+        if (command == COMMAND_NAMES[c]) return c;
+    }
+    return COMMANDS - 1;
+}
+
+void CommandMetrics::record(int command, long long nanos) {
+    int b = 0;
+    while (b < BUCKETS && nanos > BUCKET_BOUNDS[b]) b++;
+
+    // Single writer: relaxed increments are enough, readers see each counter whole
+    Histogram& h = histograms[command];
+    h.counts[b].fetch_add(1, std::memory_order_relaxed);
+    h.sumNanos.fetch_add((unsigned long long)nanos, std::memory_order_relaxed);
+}
+
+#if TRIAGE_METRICS
+// Seconds with no trailing zeros ("0.000005", "0.25", "1")
+static void writeSeconds(std::ostream& out, unsigned long long nanos) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.9f", nanos / 1e9);
+    char* end = text;
+    while (*end != '\0') end++;
+    while (end[-1] == '0') end--;
+    if (end[-1] == '.') end--;
+    *end = '\0';
+    out << text;
+}
+#endif
+
+void CommandMetrics::write(std::ostream& out) {
+#if TRIAGE_METRICS
+    out << "# HELP triage_command_duration_seconds Time the backend spent running a command\n";
+    out << "# TYPE triage_command_duration_seconds histogram\n";
+
+    for (int c = 0; c < COMMANDS; c++) {
+        const char* name = (c < COMMANDS - 1) ? COMMAND_NAMES[c] : "other";
+        Histogram& h = histograms[c];
+
+        // Cumulative counts, as Prometheus expects; commands never run are left out
+        unsigned long long running = 0;
+        unsigned long long counts[BUCKETS + 1];
+        for (int b = 0; b <= BUCKETS; b++) {
+            counts[b] = h.counts[b].load(std::memory_order_relaxed);
+            running += counts[b];
+        }
+        if (running == 0) continue;
+
+        running = 0;
+        for (int b = 0; b <= BUCKETS; b++) {
+            running += counts[b];
+            out << "triage_command_duration_seconds_bucket{command=\"" << name << "\",le=\"";
+            if (b < BUCKETS) writeSeconds(out, BUCKET_BOUNDS[b]);
+            else out << "+Inf";
+            out << "\"} " << running << "\n";
+        }
+        out << "triage_command_duration_seconds_sum{command=\"" << name << "\"} ";
+        writeSeconds(out, h.sumNanos.load(std::memory_order_relaxed));
+        out << "\n";
+        out << "triage_command_duration_seconds_count{command=\"" << name << "\"} " << running << "\n";
+    }
+#else
+    (void)out; // Nothing was recorded
+#endif
+}
+
+// ==========================================
+// GAUGES AND HEAP SHAPE
+// ==========================================
+
+void writeMetric(std::ostream& out, const char* name, const char* type, const char* help, long long value) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+    out << name << " " << value << "\n";
+}
+
+void writeHeapShape(std::ostream& out, const HeapShape& shape) {
+#if TRIAGE_METRICS
+    writeMetric(out, "triage_heap_consolidations_total", "counter",
+                "Consolidations run by extractMin", shape.consolidations);
+    writeMetric(out, "triage_heap_consolidated_roots_total", "counter",
+                "Sum of the root-list lengths consolidated", shape.rootsConsolidated);
+    writeMetric(out, "triage_heap_roots_before_consolidate", "gauge",
+                "Root-list length before the latest consolidation", shape.lastRoots);
+    writeMetric(out, "triage_heap_roots_before_consolidate_max", "gauge",
+                "Longest root list consolidated", shape.maxRoots);
+    writeMetric(out, "triage_heap_max_degree", "gauge",
+                "Highest root degree reached", shape.maxDegree);
+    writeMetric(out, "triage_heap_cascades_total", "counter",
+                "Cascading cuts that cut at least one ancestor", shape.cascades);
+    writeMetric(out, "triage_heap_cascade_cuts_total", "counter",
+                "Ancestors cut by cascading cuts", shape.cascadeCuts);
+    writeMetric(out, "triage_heap_cascade_depth_max", "gauge",
+                "Most ancestors cut by one cascading cut", shape.maxCascadeDepth);
+#endif
+    writeMetric(out, "triage_heap_roots", "gauge", "Trees in the root list", shape.roots);
+    writeMetric(out, "triage_heap_marked_nodes", "gauge",
+                "Nodes that lost a child since becoming one", shape.markedNodes);
+}
@@ -0,0 +1,73 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <ostream>
+#include <string>
+
+// Backend instrumentation, read with the METRICS command (Prometheus text format).
+//
+// Build with -DTRIAGE_METRICS=0 to compile the hot-path recording out: the
+// command timers and the heap's shape counters then cost nothing, and
+// METRICS only reports the gauges that are counted when it is asked.
+#ifndef TRIAGE_METRICS
+#define TRIAGE_METRICS 1
+#endif
+
+// Shape of a Fibonacci heap. The counters are kept by the heap as it works;
+// 'roots' and 'markedNodes' are counted when the shape is read.
+struct HeapShape {
+    long long consolidations;       // extractMin() calls that had roots left to consolidate
+    long long rootsConsolidated;    // Sum of the root-list lengths they started from
+    int lastRoots;                  // Root-list length before the latest consolidation
+    int maxRoots;                   // ... and the longest ever
+    int maxDegree;                  // Highest root degree any consolidation produced
+    long long cascades;             // Cascading cuts that cut at least one ancestor
+    long long cascadeCuts;          // Ancestors cut by those
+    int maxCascadeDepth;            // Most ancestors cut by one cascade
+    int roots;                      // Right now
+    int markedNodes;                // Right now
+};
+
+// Per-command latency histograms.
+//
+// One writer (the thread running the commands) and any number of readers:
+// every counter is an atomic updated with relaxed ordering, so recording is
+// a few uncontended increments and a reader never blocks it.
+class CommandMetrics {
+public:
+    static const int BUCKETS = 16;  // Upper bounds (see Metrics.cpp), then +Inf
+    static const int COMMANDS = 30; // Known commands, then "other"
+
+private:
+    struct Histogram {
+        std::atomic<unsigned long long> counts[BUCKETS + 1];
+        std::atomic<unsigned long long> sumNanos;
+    };
+
+    Histogram* histograms;          // COMMANDS entries
+
+    // Non-copyable: owns the histograms
+    CommandMetrics(const CommandMetrics&);
+    CommandMetrics& operator=(const CommandMetrics&);
+
+public:
+    CommandMetrics();
+    ~CommandMetrics();
+
+    // Index of a command name for record(); unknown names share the last one
+    static int commandIndex(const std::string& command);
+
+    void record(int command, long long nanos);
+
+    // The triage_command_duration_seconds histogram family
+    void write(std::ostream& out);
+};
+
+// One gauge or counter sample with its HELP and TYPE lines
+void writeMetric(std::ostream& out, const char* name, const char* type, const char* help, long long value);
+
+// The triage_heap_* family
+void writeHeapShape(std::ostream& out, const HeapShape& shape);
+
+#endif
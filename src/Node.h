@@ -1,35 +1,104 @@
 #ifndef NODE_H
 #define NODE_H
 
-#include <string>
+#include "PriorityKey.h"
 
 // ASSIGNED TO: MEMBER 1
 // The Building Block of the Heap
-struct Node {
-    int id;
-    int priority;
-    int age;            
-    std::string name;
-    std::string description; 
-
+// Only the "hot" fields touched by consolidate/cut live here.
+// The payload (for patients: name, age, description) is kept apart
+// in a record table (see Patient.h).
+template <typename Key>
+struct HeapNode {
     // Pointers
-    Node *left, *right, *parent, *child;
-    
+    HeapNode *left, *right, *parent, *child;
+
+    Key key;            // Ordering key (patients: packed ESI + tiebreakers)
+    long long id;       // Key into the ID index
+
     int degree;         // Number of children
     bool marked;          // Lost a child since last made a child?
 
     // Constructor
-Node(int _id, int _priority, int _age, std::string _name, std::string _desc);
-    
+    HeapNode(long long _id, const Key& _key) : key(_key) {
+        id = _id;
+
+        // Initialize Circular Pointers (Point to self)
+        left = this;
+        right = this;
+        parent = nullptr;
+        child = nullptr;
+
+        degree = 0;
+        marked = false;
+    }
+
     // Adds 'other' node to the right of 'this' node
-    void addSibling(Node* other);
-    
+    void addSibling(HeapNode* other) {
+        if (other == nullptr) return;
+
+        // 1. Link other to current neighbors
+        other->left = this;
+        other->right = this->right;
+
+        // 2. Link neighbors to other
+        this->right->left = other;
+        this->right = other;
+
+        // 3. Siblings share the same parent
+        other->parent = this->parent;
+    }
+
     // Removes 'this' node from the list (re-links left and right)
-    void removeSelf();
+    void removeSelf() {
+        // 1. Connect left neighbor to right neighbor
+        this->left->right = this->right;
+
+        // 2. Connect right neighbor to left neighbor
+        this->right->left = this->left;
+
+        // (Optional safety) Reset own pointers so it doesn't point to old list
+        this->left = this;
+        this->right = this;
+    }
+
+    void addChild(HeapNode* newChild) {
+        if (newChild == nullptr) return;
 
-    void addChild(Node* newChild);
-    void removeChild(Node* target);
+        if (child == nullptr) {
+            // First child: it forms a circle of one
+            child = newChild;
+            newChild->right = newChild;
+            newChild->left = newChild;
+            newChild->parent = this;
+        } else {
+            // Existing children: add as sibling to the current child pointer
+            child->addSibling(newChild);
+            newChild->parent = this;
+        }
+        degree++;
+    }
+
+    void removeChild(HeapNode* target) {
+        if (target == nullptr || child == nullptr) return;
+
+        if (child == target) {
+            if (target->right == target) {
+                child = nullptr;
+            } else {
+                child = target->right;
+            }
+        }
+
+        target->removeSelf(); // Unlink from siblings
+        target->parent = nullptr;
+        target->marked = false; // Reset mark when cut
+        degree--;
+    }
 
 };
 
-#endif
\ No newline at end of file
+// The patient queues' node
+typedef HeapNode<PriorityKey> Node;
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <new>
+#include <utility>
+#include "Node.h"
+
+// Snapshot of the pool counters (reported by the POOL command)
+struct PoolStats {
+    int live;        // Nodes currently handed out to the heap
+    int highWater;   // Most nodes ever live at the same time
+    int capacity;    // Node slots allocated across all slabs
+    int slabs;       // Number of slabs allocated so far
+};
+
+// Slab allocator for heap nodes (and, through PatientTable, patient records).
+// Objects are carved out of fixed-size slabs and recycled through a free list,
+// so a surge of ADD/EXTRACT pairs never touches the global allocator.
+template <typename T>
+class SlabPool {
+private:
+    static const int SLAB_SIZE = 256; // Objects per slab
+
+    // A free slot reuses the object's own storage as the list link
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    // One slot holds either a live object or the link: sized and aligned for
+    // both, so T may be smaller than a pointer (an int payload, say)
+    union Slot {
+        FreeSlot free;
+        alignas(T) unsigned char object[sizeof(T)];
+    };
+    static_assert(sizeof(Slot) >= sizeof(T) && sizeof(Slot) >= sizeof(FreeSlot), "slot too small");
+    static_assert(alignof(Slot) >= alignof(T) && alignof(Slot) >= alignof(FreeSlot), "slot misaligned");
+
+    struct Slab {
+        Slab* next;
+        Slot slots[SLAB_SIZE];
+    };
+
+    Slab* slabHead;
+    Slab* slabTail;
+    FreeSlot* freeHead;
+    FreeSlot* freeTail;
+
+    int liveCount;
+    int highWater;
+    int capacity;
+    int slabCount;
+
+    // Non-copyable: owns the slabs
+    SlabPool(const SlabPool&);
+    SlabPool& operator=(const SlabPool&);
+
+    // Allocates one more slab and threads it onto the free list
+    void grow() {
+        Slab* slab = new Slab;
+        slab->next = nullptr;
+
+        if (slabTail == nullptr) {
+            slabHead = slab;
+        } else {
+            slabTail->next = slab;
+        }
+        slabTail = slab;
+
+        // Thread the slots in reverse so they are handed out in address order
+        for (int i = SLAB_SIZE - 1; i >= 0; i--) {
+            FreeSlot* slot = &slab->slots[i].free;
+            slot->next = freeHead;
+            if (freeHead == nullptr) freeTail = slot;
+            freeHead = slot;
+        }
+
+        capacity += SLAB_SIZE;
+        slabCount++;
+    }
+
+public:
+    SlabPool() {
+        slabHead = nullptr;
+        slabTail = nullptr;
+        freeHead = nullptr;
+        freeTail = nullptr;
+
+        liveCount = 0;
+        highWater = 0;
+        capacity = 0;
+        slabCount = 0;
+    }
+
+    ~SlabPool() {
+        // Live objects must already be released by the owner (they may need destructors)
+        Slab* curr = slabHead;
+        while (curr != nullptr) {
+            Slab* next = curr->next;
+            delete curr;
+            curr = next;
+        }
+    }
+
+    // Constructs an object in a recycled slot (allocates a new slab if none is free).
+    // The arguments are forwarded to T's constructor, so strings are moved, not copied.
+    template <typename... Args>
+    T* acquire(Args&&... args) {
+        if (freeHead == nullptr) grow();
+
+        FreeSlot* slot = freeHead;
+        freeHead = slot->next;
+        if (freeHead == nullptr) freeTail = nullptr;
+
+        liveCount++;
+        if (liveCount > highWater) highWater = liveCount;
+
+        return new (slot) T(std::forward<Args>(args)...);
+    }
+
+    // Destroys the object and returns its slot to the free list
+    void release(T* obj) {
+        if (obj == nullptr) return;
+
+        obj->~T();
+
+        FreeSlot* slot = reinterpret_cast<FreeSlot*>(obj);
+        slot->next = freeHead;
+        if (freeHead == nullptr) freeTail = slot;
+        freeHead = slot;
+
+        liveCount--;
+    }
+
+    // Teardown only: runs a live object's destructor without recycling its
+    // slot (the whole slab is freed at once when the pool goes away)
+    void destroy(T* obj) {
+        obj->~T();
+        liveCount--;
+    }
+
+    // Makes sure 'n' more objects can be acquired without allocating
+    void reserve(int n) {
+        while (capacity - liveCount < n) grow();
+    }
+
+    // Takes over all slabs and free slots of 'other' (used by MERGE).
+    // Objects handed out by 'other' stay valid and are now owned by this pool.
+    void adopt(SlabPool& other) {
+        if (&other == this || other.slabHead == nullptr) return;
+
+        // 1. Append the other slab chain (O(1) thanks to the tail pointer)
+        if (slabTail == nullptr) {
+            slabHead = other.slabHead;
+        } else {
+            slabTail->next = other.slabHead;
+        }
+        slabTail = other.slabTail;
+
+        // 2. Append the other free list
+        if (other.freeHead != nullptr) {
+            if (freeTail == nullptr) {
+                freeHead = other.freeHead;
+            } else {
+                freeTail->next = other.freeHead;
+            }
+            freeTail = other.freeTail;
+        }
+
+        // 3. Combine the counters
+        liveCount += other.liveCount;
+        capacity += other.capacity;
+        slabCount += other.slabCount;
+        if (liveCount > highWater) highWater = liveCount;
+
+        // 4. Leave 'other' empty so its destructor frees nothing
+        other.slabHead = nullptr;
+        other.slabTail = nullptr;
+        other.freeHead = nullptr;
+        other.freeTail = nullptr;
+        other.liveCount = 0;
+        other.capacity = 0;
+        other.slabCount = 0;
+    }
+
+    // One live object now belongs to 'to' (TRANSFER between department queues).
+    // Only the counters move: the object stays where it is, in one of this
+    // pool's slabs, and 'to' recycles its slot when it is released. Pools that
+    // traded objects must be folded together with adopt() before either is
+    // destroyed, so every slab outlives the objects carved out of it.
+    void handOver(SlabPool& to) {
+        liveCount--;
+        to.liveCount++;
+        if (to.liveCount > to.highWater) to.highWater = to.liveCount;
+    }
+
+    PoolStats getStats() {
+        PoolStats stats;
+        stats.live = liveCount;
+        stats.highWater = highWater;
+        stats.capacity = capacity;
+        stats.slabs = slabCount;
+        return stats;
+    }
+};
+
+// The patient queues' node pool
+typedef SlabPool<Node> NodePool;
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef PATIENT_H
+#define PATIENT_H
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include "NodePool.h"
+
+// A patient as read from a file (snapshot, manifest), before it is queued.
+// Bulk loads collect these and hand them to TriageQueue::insertMany().
+struct PatientRow {
+    long long id;
+    int priority;
+    int age;
+    long long arrival;      // ARRIVAL_NOW = stamp when queued
+    std::string name;
+    std::string description;
+};
+
+// The "cold" part of a patient: only read when we print or save,
+// never while the heap is consolidating or cutting.
+struct PatientRecord {
+    long long id;
+    int age;
+    std::string name;
+    std::string description;
+
+    // Takes the strings by value and moves them in (no extra copy for temporaries)
+    PatientRecord(long long _id, int _age, std::string _name, std::string _desc)
+        : id(_id), age(_age), name(std::move(_name)), description(std::move(_desc)) {}
+
+    // Bulk loads: takes the row's strings
+    explicit PatientRecord(PatientRow&& row)
+        : id(row.id), age(row.age), name(std::move(row.name)), description(std::move(row.description)) {}
+};
+
+// Text protocol fields are single tokens on a single line. Names that arrived
+// with spaces, tabs or any other control byte (binary protocol, snapshots,
+// manifests) are written with '_' instead, the GUI's convention:
+//   out << textField(rec->name);
+struct TextField {
+    const std::string& value;
+};
+
+inline TextField textField(const std::string& value) {
+    TextField field = { value };
+    return field;
+}
+
+// Bytes that would split a token or a line: whitespace and ASCII controls
+inline bool breaksToken(char c) {
+    unsigned char u = (unsigned char)c;
+    return u <= ' ' || u == 0x7f;
+}
+
+inline std::ostream& operator<<(std::ostream& out, TextField field) {
+    const std::string& s = field.value;
+    size_t first = 0;
+    while (first < s.size() && !breaksToken(s[first])) first++;
+    if (first == s.size()) return out << s; // Common case: no copy
+
+    std::string token = s;
+    for (size_t i = first; i < token.size(); i++) {
+        if (breaksToken(token[i])) token[i] = '_';
+    }
+    return out << token;
+}
+
+// Storage for patient records, kept apart from the heap nodes.
+// Records live in the same kind of slabs as the nodes and are recycled
+// through a free list; lookup by Patient ID goes through the PatientIndex.
+typedef SlabPool<PatientRecord> PatientTable;
+
+#endif
@@ -0,0 +1,231 @@
+#ifndef PATIENTINDEX_H
+#define PATIENTINDEX_H
+
+#include "Node.h"
+#include "Patient.h"
+
+// SplitMix64 finalizer: consecutive IDs land far apart in the table
+inline unsigned long long mixId(long long id) {
+    unsigned long long x = (unsigned long long)id;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// REPLACEMENT FOR MAP: open-addressing hash table (linear probing)
+// Key = ID (any 64-bit value), Value = Node + Record pointers.
+// Memory follows the number of live entries: the table starts empty,
+// doubles when 3/4 full and shrinks again when it drops below 1/8.
+template <typename NodeT, typename RecordT>
+class IdIndex {
+public:
+    // One slot of the index: where to find an entry's hot node and cold record
+    struct Entry {
+        long long id;
+        NodeT* node;            // nullptr = empty slot
+        RecordT* record;
+    };
+
+private:
+    static const int MIN_CAPACITY = 16;
+
+    Entry* slots;
+    int capacity;           // Always 0 or a power of two
+    int count;
+
+    // Non-copyable: owns the table
+    IdIndex(const IdIndex&);
+    IdIndex& operator=(const IdIndex&);
+
+    void rehash(int newCapacity) {
+        Entry* oldSlots = slots;
+        int oldCapacity = capacity;
+
+        slots = new Entry[newCapacity];
+        capacity = newCapacity;
+        for (int i = 0; i < capacity; i++) slots[i].node = nullptr;
+
+        // Re-insert every live entry into the new table
+        unsigned long long mask = (unsigned long long)(capacity - 1);
+        for (int i = 0; i < oldCapacity; i++) {
+            if (oldSlots[i].node == nullptr) continue;
+
+            unsigned long long pos = mixId(oldSlots[i].id) & mask;
+            while (slots[pos].node != nullptr) pos = (pos + 1) & mask;
+            slots[pos] = oldSlots[i];
+        }
+
+        delete[] oldSlots;
+    }
+
+public:
+    IdIndex() {
+        // Nothing is allocated until the first insert, so an empty heap is cheap
+        slots = nullptr;
+        capacity = 0;
+        count = 0;
+    }
+
+    ~IdIndex() {
+        delete[] slots;
+    }
+
+    // Returns nullptr if the ID is not in the index
+    Entry* find(long long id) {
+        if (count == 0) return nullptr;
+
+        unsigned long long mask = (unsigned long long)(capacity - 1);
+        unsigned long long pos = mixId(id) & mask;
+
+        // Linear probing: stop at the first empty slot
+        while (slots[pos].node != nullptr) {
+            if (slots[pos].id == id) return &slots[pos];
+            pos = (pos + 1) & mask;
+        }
+        return nullptr;
+    }
+
+    // Returns false (and changes nothing) if the ID is already present
+    bool insert(long long id, NodeT* node, RecordT* record) {
+        if (node == nullptr) return false;
+
+        // Keep the load factor below 3/4
+        if (capacity == 0) {
+            rehash(MIN_CAPACITY);
+        } else if ((count + 1) * 4 > capacity * 3) {
+            rehash(capacity * 2);
+        }
+
+        unsigned long long mask = (unsigned long long)(capacity - 1);
+        unsigned long long pos = mixId(id) & mask;
+
+        while (slots[pos].node != nullptr) {
+            if (slots[pos].id == id) return false; // Duplicate ID
+            pos = (pos + 1) & mask;
+        }
+
+        slots[pos].id = id;
+        slots[pos].node = node;
+        slots[pos].record = record;
+        count++;
+        return true;
+    }
+
+    // Returns false if the ID was not present
+    bool erase(long long id) {
+        Entry* entry = find(id);
+        if (entry == nullptr) return false;
+
+        unsigned long long mask = (unsigned long long)(capacity - 1);
+        unsigned long long hole = (unsigned long long)(entry - slots);
+        unsigned long long pos = hole;
+
+        // Backward-shift deletion: pull later entries of the probe chain
+        // into the hole so lookups never need tombstones.
+        while (true) {
+            pos = (pos + 1) & mask;
+            if (slots[pos].node == nullptr) break;
+
+            unsigned long long home = mixId(slots[pos].id) & mask;
+            // Move the entry only if the hole lies between its home and its slot
+            bool movable = (hole <= pos) ? (home <= hole || home > pos)
+                                         : (home <= hole && home > pos);
+            if (movable) {
+                slots[hole] = slots[pos];
+                hole = pos;
+            }
+        }
+        slots[hole].node = nullptr;
+        count--;
+
+        // Give memory back once most entries have left
+        if (capacity > MIN_CAPACITY && count * 8 < capacity) {
+            rehash(capacity / 2);
+        }
+        return true;
+    }
+
+    // Moves every entry of 'other' into this index and leaves 'other' empty.
+    // Cost is O(min(size, other.size)): the smaller table is walked and
+    // re-inserted into the larger one (tables are swapped when needed).
+    // If any ID exists on both sides, nothing is moved, the first
+    // clashing ID is stored in 'collidingId' and false is returned.
+    bool absorb(IdIndex& other, long long& collidingId) {
+        if (&other == this || other.count == 0) return true;
+
+        // 1. Pick the side to walk: always the smaller one
+        IdIndex* small = (other.count <= count) ? &other : this;
+        IdIndex* large = (small == this) ? &other : this;
+
+        // 2. Collision check first, so a failed merge leaves both sides untouched
+        for (int i = 0; i < small->capacity; i++) {
+            Entry* entry = &small->slots[i];
+            if (entry->node != nullptr && large->find(entry->id) != nullptr) {
+                collidingId = entry->id;
+                return false;
+            }
+        }
+
+        // 3. Make sure the large table ends up in 'this' (O(1) pointer swap)
+        if (large != this) {
+            swap(other);
+        }
+
+        // 4. Re-insert the small side's live entries
+        reserve(count + other.count);
+        for (int i = 0; i < other.capacity; i++) {
+            Entry* entry = &other.slots[i];
+            if (entry->node != nullptr) {
+                insert(entry->id, entry->node, entry->record);
+            }
+        }
+
+        other.clear();
+        return true;
+    }
+
+    // O(1): exchanges the two tables
+    void swap(IdIndex& other) {
+        Entry* tmpSlots = slots;
+        slots = other.slots;
+        other.slots = tmpSlots;
+
+        int tmpCapacity = capacity;
+        capacity = other.capacity;
+        other.capacity = tmpCapacity;
+
+        int tmpCount = count;
+        count = other.count;
+        other.count = tmpCount;
+    }
+
+    // Drops every entry and frees the table
+    void clear() {
+        delete[] slots;
+        slots = nullptr;
+        capacity = 0;
+        count = 0;
+    }
+
+    // Pre-size for 'n' entries (avoids rehashing)
+    void reserve(int n) {
+        int needed = MIN_CAPACITY;
+        while (needed * 3 < n * 4) needed *= 2;
+        if (needed > capacity) rehash(needed);
+    }
+
+    int size() { return count; }
+
+    // Raw slot access for full sweeps (skip slots whose node is nullptr)
+    int getCapacity() { return capacity; }
+    Entry* slotAt(int i) { return &slots[i]; }
+};
+
+// The patient queues' index: Patient ID -> Node + PatientRecord
+typedef IdIndex<Node, PatientRecord> PatientIndex;
+typedef PatientIndex::Entry IndexEntry;
+
+#endif
@@ -0,0 +1,243 @@
+#include "Pipeline.h"
+#include <cctype>
+#include <sstream>
+
+// ==========================================
+// STATS FORMATTING AND PUBLISHING
+// ==========================================
+
+void writeStats(std::ostream& out, const StatsView& view) {
+    const WaitSummary& all = view.levels[0];
+    out << "STATS COUNT:" << view.count
+        << " WAIT:" << all.p50
+        << " TREATED:" << all.treated;
+    for (int level = MIN_PRIORITY; level <= MAX_PRIORITY; level++) {
+        const WaitSummary& s = view.levels[level];
+        if (s.treated == 0) continue;
+        out << " ESI" << level << ":" << s.p50 << "/" << s.p90 << "/" << s.p99;
+    }
+    out << "\n";
+}
+
+StatsBoard::StatsBoard() : sequence(0) {
+    for (int i = 0; i < CELLS; i++) cells[i].store(0, std::memory_order_relaxed);
+}
+
+void StatsBoard::publish(const StatsView& view) {
+    unsigned seq = sequence.load(std::memory_order_relaxed);
+
+    // 1. Odd sequence: readers know a publish is under way
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // 2. Copy the values
+    cells[0].store(view.count, std::memory_order_relaxed);
+    for (int level = 0; level <= MAX_PRIORITY; level++) {
+        const WaitSummary& s = view.levels[level];
+        cells[1 + level * 4].store(s.treated, std::memory_order_relaxed);
+        cells[2 + level * 4].store(s.p50, std::memory_order_relaxed);
+        cells[3 + level * 4].store(s.p90, std::memory_order_relaxed);
+        cells[4 + level * 4].store(s.p99, std::memory_order_relaxed);
+    }
+
+    // 3. Even again: the copy is complete
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+void StatsBoard::read(StatsView& view) {
+    unsigned before, after = 0;
+    do {
+        before = sequence.load(std::memory_order_acquire);
+        if (before & 1) continue; // Publish in progress: try again
+
+        view.count = (int)cells[0].load(std::memory_order_relaxed);
+        for (int level = 0; level <= MAX_PRIORITY; level++) {
+            WaitSummary& s = view.levels[level];
+            s.treated = cells[1 + level * 4].load(std::memory_order_relaxed);
+            s.p50 = (int)cells[2 + level * 4].load(std::memory_order_relaxed);
+            s.p90 = (int)cells[3 + level * 4].load(std::memory_order_relaxed);
+            s.p99 = (int)cells[4 + level * 4].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
+
+// ==========================================
+// PIPELINE
+// ==========================================
+
+Pipeline::Pipeline()
+    : input(1024), replies(1024), quick(64),
+      inputClosed(false), ownerDone(false), loggedIn(false),
+      repliesPushed(0), linesAnswered(0), audit(nullptr), idle(nullptr) {}
+
+PipelineInputBuf::int_type PipelineInputBuf::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+    // Wait for the next line (or for the reader to give up). A quiet console
+    // still escalates, syncs the log and takes audit images: the owner wakes
+    // every IDLE_MILLIS to do its timed work.
+    while (!pipe.inputBell.waitFor([this]() {
+        return !pipe.input.empty() || pipe.inputClosed.load(std::memory_order_acquire);
+    }, IDLE_MILLIS)) {
+        if (pipe.idle != nullptr) pipe.idle->onIdle();
+    }
+    if (!pipe.input.tryPop(line)) {
+        // Closed; one last look in case the final line raced with the flag
+        if (!pipe.input.tryPop(line)) return traits_type::eof();
+    }
+    linesTaken++;
+
+    char* begin = &line[0];
+    setg(begin, begin, begin + line.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+void PipelineInputBuf::replied() {
+    // 1. The writer counts replies the same way when it releases quick ones
+    pipe.repliesPushed.store(pipe.repliesPushed.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_release);
+
+    // 2. Every line taken is answered, unless the current one still holds a
+    // command (or a command is waiting for more of its arguments)
+    unsigned long long done = linesTaken;
+    for (const char* p = gptr(); p < egptr(); p++) {
+        if (!isspace((unsigned char)*p)) {
+            done--;
+            break;
+        }
+    }
+    pipe.linesAnswered.store(done, std::memory_order_release);
+}
+
+// Reader: a fast-path reply, released after every owner reply pushed so far
+static void pushQuick(Pipeline& pipe, std::string& text) {
+    QuickReply reply;
+    reply.text = std::move(text);
+    reply.after = pipe.repliesPushed.load(std::memory_order_acquire);
+    pipe.quick.push(reply);
+    pipe.outputBell.ring();
+}
+
+// Returns the first word of 'line' and puts the stream after it into 'rest'
+static std::string firstWord(const std::string& line, std::istringstream& rest) {
+    rest.str(line);
+    std::string word;
+    rest >> word;
+    return word;
+}
+
+void runReader(Pipeline& pipe, std::istream& in) {
+    // Frame tracking, so commands inside BEGIN/BATCH blocks are never answered
+    // early: -1 = inside BEGIN ... END, n > 0 = n lines of a BATCH block left.
+    // (BATCH blocks are expected to send one command per line, like the bridge does.)
+    int frame = 0;
+    bool exitSeen = false;
+    unsigned long long linesSent = 0;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream rest;
+        std::string word = firstWord(line, rest);
+        if (word.empty()) continue;
+
+        // 1. Fast path at top level: PING always, STATS and AUDIT once someone
+        // is logged in, answered without waking the owner. Only while the owner
+        // has answered everything sent so far: the reply must not overtake
+        // theirs, and the published view then already includes those commands.
+        bool ownerIdle = frame == 0 && pipe.linesAnswered.load(std::memory_order_acquire) == linesSent;
+        if (ownerIdle && word == "PING") {
+            std::string reply = "PONG\n";
+            pushQuick(pipe, reply);
+            continue;
+        }
+        if (ownerIdle && word == "STATS" && pipe.loggedIn.load(std::memory_order_acquire)) {
+            StatsView view;
+            pipe.stats.read(view);
+            std::ostringstream reply;
+            writeStats(reply, view);
+            std::string text = reply.str();
+            pushQuick(pipe, text);
+            continue;
+        }
+        if (ownerIdle && word == "AUDIT" && pipe.audit != nullptr &&
+            pipe.loggedIn.load(std::memory_order_acquire)) {
+            std::string when;
+            rest >> when;
+            std::ostringstream reply;
+            pipe.audit->query(when, reply);
+            std::string text = reply.str();
+            pushQuick(pipe, text);
+            continue;
+        }
+
+        // 2. Follow the framing, and spot the EXIT that will stop the owner
+        if (frame == 0) {
+            if (word == "BEGIN") {
+                frame = -1;
+            } else if (word == "BATCH") {
+                int n = 0;
+                rest >> n;
+                if (n > 0) frame = n;
+            } else if (word == "EXIT") {
+                exitSeen = true;
+            }
+        } else if (frame == -1) {
+            if (word == "END") frame = 0;
+            else if (word == "EXIT") exitSeen = true;
+        } else {
+            if (word == "EXIT") exitSeen = true;
+            frame--;
+        }
+
+        // 3. Everything else goes to the owner, in order
+        line += '\n';
+        pipe.input.push(line);
+        linesSent++;
+        pipe.inputBell.ring();
+
+        // The owner stops after this line (or after this block): stop reading too
+        if (exitSeen && frame == 0) break;
+    }
+
+    pipe.inputClosed.store(true, std::memory_order_release);
+    pipe.inputBell.ring();
+}
+
+void runWriter(Pipeline& pipe, std::ostream& out) {
+    std::string text;
+    QuickReply held;            // Popped, waiting for the owner replies before it
+    bool holding = false;
+    unsigned long long written = 0;
+
+    while (true) {
+        pipe.outputBell.wait([&pipe, &holding]() {
+            return !pipe.replies.empty() || (!holding && !pipe.quick.empty()) ||
+                   pipe.ownerDone.load(std::memory_order_acquire);
+        });
+
+        // Read the flag first: once it is set, every reply is already in the ring
+        bool done = pipe.ownerDone.load(std::memory_order_acquire);
+
+        // Drain everything available in request order, then flush once
+        // (one pipe write per burst)
+        while (true) {
+            if (!holding) holding = pipe.quick.tryPop(held);
+            if (holding && held.after <= written) {
+                out << held.text;
+                holding = false;
+            } else if (pipe.replies.tryPop(text)) {
+                out << text;
+                written++;
+            } else {
+                break;
+            }
+        }
+        if (done && holding) out << held.text; // Its owner replies never came: don't lose it
+        out.flush();
+
+        if (done) break;
+    }
+}
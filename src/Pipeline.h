@@ -0,0 +1,107 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <atomic>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include "SpscRing.h"
+#include "WaitStats.h"
+#include "AuditTrail.h"
+#include "Server.h"
+
+// What STATS reports, as one plain value (row 0 of 'levels' = all levels)
+struct StatsView {
+    int count;                              // Patients waiting
+    WaitSummary levels[MAX_PRIORITY + 1];   // Observed waits per ESI level
+};
+
+// Formats the STATS reply line (shared by the owner and the reader's fast path)
+void writeStats(std::ostream& out, const StatsView& view);
+
+// Seqlock around the latest StatsView: one writer (the heap owner) publishes
+// after every command, any thread reads a consistent copy without locking.
+class StatsBoard {
+private:
+    static const int CELLS = 1 + (MAX_PRIORITY + 1) * 4;
+
+    std::atomic<unsigned> sequence;         // Odd while a publish is in progress
+    std::atomic<long long> cells[CELLS];
+
+    StatsBoard(const StatsBoard&);
+    StatsBoard& operator=(const StatsBoard&);
+
+public:
+    StatsBoard();
+
+    void publish(const StatsView& view);
+    void read(StatsView& view);
+};
+
+// Everything the three backend threads share.
+//
+//   reader  --input-->   owner   --replies-->  writer  --> stdout
+//      \___________________quick____________________/
+//
+// The reader splits stdin into lines for the owner (the only thread touching
+// the queue) and answers PING, and STATS and AUDIT once logged in, from
+// 'stats' and 'audit' on its own through 'quick'. The writer drains both
+// reply rings and flushes once per burst.
+//
+// Replies leave in request order. The reader only takes the fast path while
+// the owner has answered every line sent to it, and tags the quick reply
+// with the owner's reply count at that moment; the writer holds it back
+// until that many owner replies are out.
+struct QuickReply {
+    std::string text;
+    unsigned long long after;       // Owner replies that go out first
+};
+
+struct Pipeline {
+    SpscRing<std::string> input;    // Command lines, reader -> owner
+    SpscRing<std::string> replies;  // One reply block per command, owner -> writer
+    SpscRing<QuickReply> quick;     // Fast-path replies, reader -> writer
+
+    Doorbell inputBell;             // Owner sleeps here when there is no input
+    Doorbell outputBell;            // Writer sleeps here when there is nothing to send
+
+    std::atomic<bool> inputClosed;  // The reader stopped (EOF or EXIT seen)
+    std::atomic<bool> ownerDone;    // The owner stopped; the writer drains and quits
+    std::atomic<bool> loggedIn;     // Published by the owner: enables the STATS fast path
+    std::atomic<unsigned long long> repliesPushed;  // Owner: replies in 'replies' so far
+    std::atomic<unsigned long long> linesAnswered;  // Owner: input lines with every command answered
+    StatsBoard stats;
+    AuditTrail* audit;              // The owner's trail (images are safe to read from here)
+    SessionHandler* idle;           // The owner's timed work, run while no input comes
+
+    Pipeline();
+};
+
+// std::istream source that pulls lines from Pipeline::input, so the owner
+// parses commands with ordinary >> exactly as it did from std::cin.
+// While no input comes, it runs the owner's idle work (aging, group commit,
+// audit images) the same way the server does between poll rounds.
+class PipelineInputBuf : public std::streambuf {
+private:
+    static const int IDLE_MILLIS = 200;     // The log's group-commit interval
+
+    Pipeline& pipe;
+    std::string line;   // Line currently being read
+    unsigned long long linesTaken;
+
+protected:
+    int_type underflow();
+
+public:
+    PipelineInputBuf(Pipeline& p) : pipe(p), linesTaken(0) {}
+
+    // Owner: call after pushing a command's reply block to 'replies'
+    void replied();
+};
+
+// Thread bodies
+void runReader(Pipeline& pipe, std::istream& in);
+void runWriter(Pipeline& pipe, std::ostream& out);
+
+#endif
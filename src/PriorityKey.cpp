@@ -0,0 +1,28 @@
+#include "PriorityKey.h"
+#include <atomic>
+#include <chrono>
+
+// ==========================================
+// ARRIVAL CLOCK
+// ==========================================
+
+static std::atomic<long long> lastArrival(0);
+
+long long arrivalClock() {
+    long long now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // Two patients never share a stamp, even within one microsecond
+    long long last = lastArrival.load();
+    long long next;
+    do {
+        next = (now > last) ? now : last + 1;
+    } while (!lastArrival.compare_exchange_weak(last, next));
+    return next;
+}
+
+void noteArrival(long long arrival) {
+    long long last = lastArrival.load();
+    while (arrival > last && !lastArrival.compare_exchange_weak(last, arrival)) {
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef PRIORITYKEY_H
+#define PRIORITYKEY_H
+
+// Composite priority keys
+//
+// A key packs everything that decides "who is seen first" into one
+// unsigned 64-bit value, so the heap orders patients with a single
+// integer compare (smaller key = more urgent):
+//
+//   EsiArrivalKey:     [ ESI : 8 ][ arrival : 56 ]
+//   EsiAgeArrivalKey:  [ ESI : 8 ][ age risk : 2 ][ arrival : 54 ]
+//
+// 'arrival' is microseconds since the Unix epoch, so equal ESI levels
+// come out first-come, first-served. The policy is a template parameter
+// of FibonacciHeap: picking one costs no branch at run time.
+
+typedef unsigned long long PriorityKey;
+
+// Passed as an arrival time to mean "stamp it with the current time"
+const long long ARRIVAL_NOW = -1;
+
+// Arrival stamp: microseconds since the epoch, strictly increasing across
+// the whole process (so scratch queues built for MERGE never jump ahead)
+long long arrivalClock();
+
+// Records a restored stamp, so fresh stamps are always later than it
+void noteArrival(long long arrival);
+
+// ESI level first, then arrival time
+struct EsiArrivalKey {
+    static const int ARRIVAL_BITS = 56;
+    static const PriorityKey ARRIVAL_MASK = (1ULL << ARRIVAL_BITS) - 1;
+
+    static bool fits(int level) { return level >= 0 && level <= 255; }
+
+    static PriorityKey pack(int level, int age, long long arrival) {
+        (void)age;
+        return ((PriorityKey)level << ARRIVAL_BITS) | ((PriorityKey)arrival & ARRIVAL_MASK);
+    }
+
+    // Same patient, new ESI level (arrival and modifiers are kept)
+    static PriorityKey withLevel(PriorityKey key, int level) {
+        return ((PriorityKey)level << ARRIVAL_BITS) | (key & ARRIVAL_MASK);
+    }
+
+    static int level(PriorityKey key) { return (int)(key >> ARRIVAL_BITS); }
+    static long long arrival(PriorityKey key) { return (long long)(key & ARRIVAL_MASK); }
+};
+
+// ESI level first, then age risk (infants and the elderly go earlier), then arrival
+struct EsiAgeArrivalKey {
+    static const int ARRIVAL_BITS = 54;
+    static const int RISK_BITS = 2;
+    static const PriorityKey ARRIVAL_MASK = (1ULL << ARRIVAL_BITS) - 1;
+    static const PriorityKey LOW_MASK = (1ULL << (ARRIVAL_BITS + RISK_BITS)) - 1;
+
+    static bool fits(int level) { return level >= 0 && level <= 255; }
+
+    // 0 = high risk, 1 = elevated, 2 = standard
+    static int ageRisk(int age) {
+        if (age < 2 || age >= 80) return 0;
+        if (age < 6 || age >= 65) return 1;
+        return 2;
+    }
+
+    static PriorityKey pack(int level, int age, long long arrival) {
+        return ((PriorityKey)level << (ARRIVAL_BITS + RISK_BITS))
+             | ((PriorityKey)ageRisk(age) << ARRIVAL_BITS)
+             | ((PriorityKey)arrival & ARRIVAL_MASK);
+    }
+
+    static PriorityKey withLevel(PriorityKey key, int level) {
+        return ((PriorityKey)level << (ARRIVAL_BITS + RISK_BITS)) | (key & LOW_MASK);
+    }
+
+    static int level(PriorityKey key) { return (int)(key >> (ARRIVAL_BITS + RISK_BITS)); }
+    static long long arrival(PriorityKey key) { return (long long)(key & ARRIVAL_MASK); }
+};
+
+#endif
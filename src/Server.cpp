@@ -0,0 +1,379 @@
+#include "Server.h"
+#include "WireProtocol.h"
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef WSAPOLLFD PollEntry;
+static int pollSockets(PollEntry* fds, int n, int timeoutMs) { return WSAPoll(fds, (ULONG)n, timeoutMs); }
+static void closeSocket(SocketHandle s) { closesocket((SOCKET)s); }
+static bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static bool interrupted() { return WSAGetLastError() == WSAEINTR; }
+static const SocketHandle NO_SOCKET = (SocketHandle)INVALID_SOCKET;
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+typedef struct pollfd PollEntry;
+static int pollSockets(PollEntry* fds, int n, int timeoutMs) { return poll(fds, (nfds_t)n, timeoutMs); }
+static void closeSocket(SocketHandle s) { close(s); }
+static bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+static bool interrupted() { return errno == EINTR; }
+static const SocketHandle NO_SOCKET = -1;
+#endif
+
+// ==========================================
+// SOCKET SERVER IMPLEMENTATION
+// ==========================================
+
+static std::atomic<bool> stopRequested(false);
+
+static void onStopSignal(int) {
+    stopRequested.store(true);
+}
+
+static bool setNonBlocking(SocketHandle sock) {
+#ifdef _WIN32
+    u_long on = 1;
+    return ioctlsocket((SOCKET)sock, FIONBIO, &on) == 0;
+#else
+    int flags = fcntl(sock, F_GETFL, 0);
+    return flags >= 0 && fcntl(sock, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+SocketServer::SocketServer() {
+    listener = NO_SOCKET;
+    sessions = nullptr;
+    numSessions = 0;
+    capacity = 0;
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+}
+
+SocketServer::~SocketServer() {
+    while (numSessions > 0) closeSession(numSessions - 1);
+    delete[] sessions;
+
+    if (listener != NO_SOCKET) closeSocket(listener);
+#ifndef _WIN32
+    if (!unixPath.empty()) unlink(unixPath.c_str());
+#else
+    WSACleanup();
+#endif
+}
+
+bool SocketServer::listen(const std::string& address) {
+    // 1. Unix-domain socket: "unix:<path>"
+    if (address.compare(0, 5, "unix:") == 0) {
+#ifdef _WIN32
+        std::cerr << "Unix-domain sockets are not supported on this platform\n";
+        return false;
+#else
+        std::string path = address.substr(5);
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Bad socket path '" << path << "'\n";
+            return false;
+        }
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener == NO_SOCKET) return false;
+        unlink(path.c_str()); // Left over from a crashed run
+        if (bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listener, 64) != 0) {
+            std::cerr << "Cannot listen on " << path << "\n";
+            return false;
+        }
+        unixPath = path;
+        return setNonBlocking(listener);
+#endif
+    }
+
+    // 2. TCP: "<port>" (loopback only) or "<host>:<port>"
+    std::string host = "127.0.0.1";
+    std::string port = address;
+    size_t colon = address.rfind(':');
+    if (colon != std::string::npos) {
+        host = address.substr(0, colon);
+        port = address.substr(colon + 1);
+    }
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)atoi(port.c_str()));
+    if (port.empty() || inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Bad listen address '" << address << "'\n";
+        return false;
+    }
+
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == NO_SOCKET) return false;
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+    if (bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listener, 64) != 0) {
+        std::cerr << "Cannot listen on " << address << "\n";
+        return false;
+    }
+    return setNonBlocking(listener);
+}
+
+void SocketServer::requestStop() {
+    stopRequested.store(true);
+}
+
+void SocketServer::addSession(SocketHandle sock) {
+    if (numSessions == capacity) {
+        int newCapacity = (capacity == 0) ? 16 : capacity * 2;
+        ClientSession** bigger = new ClientSession*[newCapacity];
+        for (int i = 0; i < numSessions; i++) bigger[i] = sessions[i];
+        delete[] sessions;
+        sessions = bigger;
+        capacity = newCapacity;
+    }
+
+    ClientSession* session = new ClientSession();
+    session->sock = sock;
+    session->loggedIn = false;
+    session->closing = false;
+    session->binary = false;
+    sessions[numSessions++] = session;
+}
+
+void SocketServer::closeSession(int i) {
+    closeSocket(sessions[i]->sock);
+    delete sessions[i];
+
+    // Order does not matter: move the last session into the gap
+    sessions[i] = sessions[numSessions - 1];
+    numSessions--;
+}
+
+void SocketServer::acceptClients() {
+    while (true) {
+        SocketHandle client = accept(listener, nullptr, nullptr);
+        if (client == NO_SOCKET) return; // No more pending connections
+
+        if (!setNonBlocking(client)) {
+            closeSocket(client);
+            continue;
+        }
+        // Replies are small and latency matters more than packet count
+        int on = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+        addSession(client);
+    }
+}
+
+bool SocketServer::receive(ClientSession& session) {
+    char chunk[16384];
+    while (session.input.size() < MAX_PENDING_INPUT) {
+        int n = (int)recv(session.sock, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            session.input.append(chunk, n);
+            continue;
+        }
+        if (n == 0) return false; // Peer closed
+        return wouldBlock() || interrupted();
+    }
+    return true; // The rest stays in the socket until these commands have run
+}
+
+bool SocketServer::flush(ClientSession& session) {
+    size_t sent = 0;
+    while (sent < session.output.size()) {
+        int n = (int)send(session.sock, session.output.data() + sent,
+                          (int)(session.output.size() - sent), 0);
+        if (n > 0) {
+            sent += n;
+            continue;
+        }
+        if (n < 0 && (wouldBlock() || interrupted())) break; // Socket full: POLLOUT later
+        return false;
+    }
+    session.output.erase(0, sent);
+    return true;
+}
+
+size_t SocketServer::unitLength(const std::string& buffer, size_t from) {
+    // The first line decides how far the unit reaches
+    size_t end = buffer.find('\n', from);
+    if (end == std::string::npos) return 0;
+
+    std::istringstream first(buffer.substr(from, end - from));
+    std::string word;
+    first >> word;
+
+    // BEGIN ... END: up to the line starting with END
+    // BATCH <n>: the next n lines (one command per line)
+    int linesLeft = 0;
+    bool untilEnd = false;
+    if (word == "BEGIN") {
+        untilEnd = true;
+    } else if (word == "BATCH") {
+        first >> linesLeft;
+        if (!first || linesLeft < 0) linesLeft = 0; // The handler reports the bad size
+    }
+
+    while (untilEnd || linesLeft > 0) {
+        size_t start = end + 1;
+        end = buffer.find('\n', start);
+        if (end == std::string::npos) return 0;
+
+        if (untilEnd) {
+            std::istringstream line(buffer.substr(start, end - start));
+            std::string next;
+            line >> next;
+            if (next == "END") untilEnd = false;
+        } else {
+            linesLeft--;
+        }
+    }
+    return end + 1 - from;
+}
+
+size_t SocketServer::frameLength(const std::string& buffer, size_t from, bool& tooLarge) {
+    tooLarge = false;
+    if (buffer.size() - from < sizeof(WireHeader)) return 0;
+
+    WireHeader header;
+    memcpy(&header, buffer.data() + from, sizeof(header));
+    if (header.length > WIRE_MAX_PAYLOAD) {
+        tooLarge = true;
+        return 0;
+    }
+
+    size_t total = sizeof(WireHeader) + header.length;
+    return (buffer.size() - from >= total) ? total : 0;
+}
+
+void SocketServer::runPending(ClientSession& session, SessionHandler& handler) {
+    // Pipelining: run every complete unit that has arrived, in order, while
+    // the client keeps up with the replies (the rest waits in 'input')
+    size_t pos = 0;
+    while (!session.closing && session.output.size() <= MAX_PENDING_OUTPUT) {
+        size_t length;
+        bool keep;
+
+        if (session.binary) {
+            // Binary frames are handed over in place (no copy out of the buffer)
+            bool tooLarge;
+            length = frameLength(session.input, pos, tooLarge);
+            if (tooLarge) {
+                session.closing = true;
+                break;
+            }
+            if (length == 0) break;
+            keep = handler.handleFrame(session.input.data() + pos, length, session.loggedIn, session.output);
+        } else {
+            length = unitLength(session.input, pos);
+            if (length == 0) break;
+
+            std::string unit = session.input.substr(pos, length);
+            std::istringstream first(unit);
+            std::string word;
+            first >> word;
+
+            if (word == "BINARY") {
+                // Handshake: everything after this line is binary frames
+                session.output += "SUCCESS_BINARY " + std::to_string(WIRE_VERSION) + "\n";
+                session.binary = true;
+                keep = true;
+            } else {
+                keep = handler.handleCommands(unit, session.loggedIn, session.output);
+            }
+        }
+
+        if (!keep) session.closing = true;
+        pos += length;
+    }
+    session.input.erase(0, pos);
+}
+
+void SocketServer::run(SessionHandler& handler) {
+    stopRequested.store(false);
+    signal(SIGINT, onStopSignal);
+    signal(SIGTERM, onStopSignal);
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN); // A vanished client must not kill the backend
+#endif
+
+    PollEntry* fds = nullptr;
+    int fdCapacity = 0;
+
+    while (!stopRequested.load()) {
+        // 1. Listener first, then one entry per session
+        if (fdCapacity < numSessions + 1) {
+            delete[] fds;
+            fdCapacity = (numSessions + 1) * 2;
+            fds = new PollEntry[fdCapacity];
+        }
+        fds[0].fd = listener;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        int polled = numSessions;
+        for (int i = 0; i < polled; i++) {
+            fds[i + 1].fd = sessions[i]->sock;
+            // Behind on its replies: only send until it catches up
+            bool backlogged = sessions[i]->output.size() > MAX_PENDING_OUTPUT;
+            fds[i + 1].events = backlogged ? 0 : POLLIN;
+            if (!sessions[i]->output.empty()) fds[i + 1].events |= POLLOUT;
+            fds[i + 1].revents = 0;
+        }
+
+        // 2. Wait (the timeout keeps timed work such as aging going)
+        int ready = pollSockets(fds, polled + 1, 1000);
+        if (ready < 0 && !interrupted()) break;
+
+        // 3. Serve the sessions that were polled (new ones are appended after them)
+        for (int i = polled - 1; i >= 0; i--) {
+            ClientSession& session = *sessions[i];
+            short events = fds[i + 1].revents;
+            bool alive = true;
+
+            if (events & (POLLIN | POLLHUP | POLLERR)) {
+                alive = receive(session);
+            }
+            // Run what arrived (even from a closing peer), and what waited for
+            // the reply backlog to drain
+            if (!session.input.empty()) runPending(session, handler);
+
+            // All complete commands ran and the rest is still too big: one
+            // command that never ends
+            if (!session.closing && session.output.size() <= MAX_PENDING_OUTPUT &&
+                session.input.size() >= MAX_PENDING_INPUT) {
+                alive = false;
+                session.output.clear();
+            }
+            if (alive || !session.output.empty()) {
+                if (!flush(session)) alive = false;
+            }
+            if (!alive || (session.closing && session.output.empty())) {
+                closeSession(i);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) acceptClients();
+        handler.onIdle();
+    }
+
+    delete[] fds;
+}
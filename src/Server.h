@@ -0,0 +1,96 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+#include <cstddef>
+
+#ifdef _WIN32
+typedef unsigned long long SocketHandle;    // SOCKET
+#else
+typedef int SocketHandle;
+#endif
+
+// What the server runs for its clients (implemented by System)
+class SessionHandler {
+public:
+    virtual ~SessionHandler() {}
+
+    // Runs one complete unit of commands (a line, or a whole BEGIN/BATCH block)
+    // for a client and appends the replies to 'reply'. 'loggedIn' is that
+    // client's own login state. Returns false when the client asked to leave (EXIT).
+    virtual bool handleCommands(const std::string& unit, bool& loggedIn, std::string& reply) = 0;
+
+    // Runs one binary frame (WireHeader + payload, see WireProtocol.h) read in
+    // place from the receive buffer and appends the response frame to 'reply'.
+    // Returns false when the client asked to leave.
+    virtual bool handleFrame(const char* frame, size_t length, bool& loggedIn, std::string& reply) = 0;
+
+    // Called after every poll round (at least once a second) for timed work
+    virtual void onIdle() = 0;
+};
+
+// One connected client
+struct ClientSession {
+    SocketHandle sock;
+    bool loggedIn;      // Every connection logs in on its own
+    bool closing;       // EXIT or hang-up: close once 'output' is sent
+    bool binary;        // Switched to binary frames by the BINARY handshake
+    std::string input;  // Received bytes not yet run (partial lines / blocks)
+    std::string output; // Replies not yet accepted by the socket
+};
+
+// Single-threaded, non-blocking socket server (poll / WSAPoll).
+//
+// Serves many sessions from one thread, so the handler (and the queue behind
+// it) is never entered concurrently. Clients may pipeline: every complete
+// command in the receive buffer is run in order and all replies leave in as
+// few send() calls as the socket allows. A client that falls behind on its
+// replies is not read from (nor its commands run) until the backlog drains,
+// so a pipelining client is paced, never dropped; only a single unfinished
+// command larger than MAX_PENDING_INPUT closes the connection.
+//
+// Addresses: "<port>" (127.0.0.1), "<host>:<port>" (TCP), or "unix:<path>"
+// (Unix-domain socket, POSIX only).
+class SocketServer {
+private:
+    static const size_t MAX_PENDING_INPUT = 1 << 20;    // Drop clients whose unfinished command outgrows this
+    static const size_t MAX_PENDING_OUTPUT = 16 << 20;  // Stop reading from clients this far behind on replies
+
+    SocketHandle listener;
+    std::string unixPath;       // Removed again on shutdown
+
+    ClientSession** sessions;   // Raw array, doubles when full
+    int numSessions;
+    int capacity;
+
+    // Non-copyable: owns the sockets
+    SocketServer(const SocketServer&);
+    SocketServer& operator=(const SocketServer&);
+
+    void acceptClients();
+    void addSession(SocketHandle sock);
+    bool receive(ClientSession& session);   // false = connection is gone (reads up to MAX_PENDING_INPUT)
+    bool flush(ClientSession& session);     // false = connection is gone
+    void runPending(ClientSession& session, SessionHandler& handler);
+    void closeSession(int i);
+
+public:
+    SocketServer();
+    ~SocketServer();
+
+    // Binds and listens; false (with a message on stderr) on failure
+    bool listen(const std::string& address);
+
+    // Serves clients until requestStop() (also wired to SIGINT / SIGTERM)
+    void run(SessionHandler& handler);
+    static void requestStop();
+
+    // Length of the first complete command unit in 'buffer' from 'from'
+    // (through its final newline), or 0 if more bytes are needed
+    static size_t unitLength(const std::string& buffer, size_t from);
+
+    // Same for a binary frame; also 0 if the frame could never be valid ('tooLarge')
+    static size_t frameLength(const std::string& buffer, size_t from, bool& tooLarge);
+};
+
+#endif
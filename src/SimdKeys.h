@@ -0,0 +1,150 @@
+#ifndef SIMDKEYS_H
+#define SIMDKEYS_H
+
+#include <functional>
+
+// Key comparisons over contiguous runs, used by FibonacciHeap's wide
+// consolidate (see consolidateWide()). The heap pairs up neighbouring roots
+// of equal degree and needs, for every pair, which of the two comes out first.
+//
+// Any Key / Compare goes through the scalar loop. Plain 64-bit unsigned keys
+// in std::less order (the patient queues' PriorityKey) use a vector kernel
+// picked once at run time: AVX2 when the CPU has it, NEON on ARM64 (always
+// there), the scalar loop otherwise. The result is the same either way, ties
+// included: a pair only swaps when the second key strictly comes first.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMDKEYS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMDKEYS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang compile the AVX2 kernel for AVX2 only (the rest of the build
+// keeps its baseline flags); MSVC accepts the intrinsics anywhere
+#if defined(SIMDKEYS_X86) && defined(__GNUC__)
+#define SIMDKEYS_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define SIMDKEYS_AVX2_TARGET
+#endif
+
+namespace simdkeys {
+
+// ==========================================
+// KERNELS: bFirst[i] = 1 when keys[2i + 1] < keys[2i]
+// ==========================================
+
+inline void lessPairsScalar(const unsigned long long* keys, int pairs, unsigned char* bFirst) {
+    for (int i = 0; i < pairs; i++) bFirst[i] = (keys[2 * i + 1] < keys[2 * i]) ? 1 : 0;
+}
+
+#ifdef SIMDKEYS_X86
+SIMDKEYS_AVX2_TARGET
+inline void lessPairsAvx2(const unsigned long long* keys, int pairs, unsigned char* bFirst) {
+    // AVX2 only compares signed 64-bit lanes: flipping the top bit of both
+    // sides turns the unsigned order into the signed one
+    const __m256i flip = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+
+    int i = 0;
+    for (; i + 2 <= pairs; i += 2) {
+        // [a0 b0 a1 b1] against [b0 a0 b1 a1]: lanes 0 and 2 say "b before a"
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(keys + 2 * i)), flip);
+        __m256i swapped = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(v, swapped)));
+
+        bFirst[i] = (unsigned char)(mask & 1);
+        bFirst[i + 1] = (unsigned char)((mask >> 2) & 1);
+    }
+    lessPairsScalar(keys + 2 * i, pairs - i, bFirst + i);
+}
+
+inline bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    // AVX2 flag (leaf 7) and an OS that saves the YMM registers (XGETBV)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+#ifdef SIMDKEYS_NEON
+inline void lessPairsNeon(const unsigned long long* keys, int pairs, unsigned char* bFirst) {
+    int i = 0;
+    for (; i + 2 <= pairs; i += 2) {
+        // De-interleaving load: val[0] = first of each pair, val[1] = second
+        uint64x2x2_t v = vld2q_u64((const uint64_t*)(keys + 2 * i));
+        uint64x2_t mask = vcltq_u64(v.val[1], v.val[0]);
+        bFirst[i] = (unsigned char)(vgetq_lane_u64(mask, 0) & 1);
+        bFirst[i + 1] = (unsigned char)(vgetq_lane_u64(mask, 1) & 1);
+    }
+    lessPairsScalar(keys + 2 * i, pairs - i, bFirst + i);
+}
+#endif
+
+// ==========================================
+// RUN-TIME DISPATCH
+// ==========================================
+
+typedef void (*LessPairsFn)(const unsigned long long*, int, unsigned char*);
+
+struct LessPairsKernel {
+    LessPairsFn fn;
+    const char* name;
+};
+
+// Probed on first use, then a plain indirect call
+inline const LessPairsKernel& lessPairsKernel() {
+    static const LessPairsKernel kernel = []() {
+        LessPairsKernel k = { lessPairsScalar, "scalar" };
+#if defined(SIMDKEYS_X86)
+        if (cpuHasAvx2()) {
+            k.fn = lessPairsAvx2;
+            k.name = "avx2";
+        }
+#elif defined(SIMDKEYS_NEON)
+        k.fn = lessPairsNeon;
+        k.name = "neon";
+#endif
+        return k;
+    }();
+    return kernel;
+}
+
+// "avx2", "neon" or "scalar" (reported by the benches)
+inline const char* kernelName() { return lessPairsKernel().name; }
+
+} // namespace simdkeys
+
+// ==========================================
+// PAIRWISE ORDER: bFirst[i] = 1 when keys[2i + 1] comes out before keys[2i]
+// ==========================================
+
+// Any key and order: one Compare call per pair
+template <typename Key, typename Compare>
+struct PairwiseOrder {
+    static void run(const Key* keys, int pairs, unsigned char* bFirst, const Compare& comp) {
+        for (int i = 0; i < pairs; i++) bFirst[i] = comp(keys[2 * i + 1], keys[2 * i]) ? 1 : 0;
+    }
+};
+
+// Min-heap of 64-bit keys (PriorityKey)
+template <>
+struct PairwiseOrder<unsigned long long, std::less<unsigned long long> > {
+    static void run(const unsigned long long* keys, int pairs, unsigned char* bFirst,
+                    const std::less<unsigned long long>&) {
+        simdkeys::lessPairsKernel().fn(keys, pairs, bFirst);
+    }
+};
+
+#endif
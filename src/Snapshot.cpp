@@ -0,0 +1,126 @@
+#include "Snapshot.h"
+#include "MappedFile.h"
+#include "DurableFile.h"
+#include <cstdio>
+#include <cstring>
+
+// ==========================================
+// BINARY SNAPSHOT IMPLEMENTATION
+// ==========================================
+
+bool Snapshot::save(TriageQueue& queue, long long nextId, std::string filename) {
+    std::string tempFilename = filename + ".tmp";
+    FILE* file = fopen(tempFilename.c_str(), "wb");
+    if (file == nullptr) return false;
+
+    // Big stdio buffer: one write syscall per 64 KB instead of per record
+    static char buffer[1 << 16];
+    setvbuf(file, buffer, _IOFBF, sizeof(buffer));
+
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+    header.version = SNAPSHOT_VERSION;
+    header.count = (uint64_t)queue.getNumNodes();
+    header.nextId = nextId;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    queue.forEachPatient([&](const TriageEntry& entry) {
+        PatientRecord* rec = entry.record;
+        SnapshotRecord out;
+        out.id = entry.id;
+        out.priority = entry.priority;
+        out.age = rec->age;
+        out.arrival = entry.arrival;
+        out.nameLen = (uint32_t)rec->name.size();
+        out.descLen = (uint32_t)rec->description.size();
+
+        ok = ok && fwrite(&out, sizeof(out), 1, file) == 1;
+        ok = ok && fwrite(rec->name.data(), 1, out.nameLen, file) == out.nameLen;
+        ok = ok && fwrite(rec->description.data(), 1, out.descLen, file) == out.descLen;
+    });
+
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        remove(tempFilename.c_str());
+        return false;
+    }
+
+    // Replace the old snapshot only once the new one is complete and on disk
+    return replaceFile(tempFilename, filename);
+}
+
+bool Snapshot::load(TriageQueue& queue, long long& nextId, std::string filename) {
+    MappedFile file;
+    if (!file.open(filename)) return false;
+
+    const char* p = file.data();
+    const char* end = p + file.size();
+
+    // 1. Validate the header
+    if (file.size() < sizeof(SnapshotHeader)) return false;
+    SnapshotHeader header;
+    memcpy(&header, p, sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, 4) != 0) return false;
+    if (header.version != 1 && header.version != SNAPSHOT_VERSION) return false;
+    p += sizeof(header);
+    size_t recordSize = (header.version == 1) ? sizeof(SnapshotRecordV1) : sizeof(SnapshotRecord);
+
+    // 2. Read every row first (a count the file can't hold is damage, not a size)
+    if (header.count > (uint64_t)(end - p) / recordSize) return false;
+    int count = (int)header.count;
+    PatientRow* rows = new PatientRow[count];
+
+    for (int i = 0; i < count; i++) {
+        if ((size_t)(end - p) < recordSize) {
+            delete[] rows;
+            return false;
+        }
+        SnapshotRecord rec;
+        if (header.version == 1) {
+            SnapshotRecordV1 old;
+            memcpy(&old, p, sizeof(old));
+            rec.id = old.id;
+            rec.priority = old.priority;
+            rec.age = old.age;
+            rec.arrival = ARRIVAL_NOW;
+            rec.nameLen = old.nameLen;
+            rec.descLen = old.descLen;
+        } else {
+            memcpy(&rec, p, sizeof(rec));
+        }
+        p += recordSize;
+
+        if ((size_t)(end - p) < (size_t)rec.nameLen + rec.descLen) {
+            delete[] rows;
+            return false;
+        }
+        PatientRow& row = rows[i];
+        row.id = rec.id;
+        row.priority = rec.priority;
+        row.age = rec.age;
+        row.arrival = rec.arrival;
+        row.name.assign(p, rec.nameLen);
+        p += rec.nameLen;
+        row.description.assign(p, rec.descLen);
+        p += rec.descLen;
+
+        if (rec.id >= nextId) nextId = rec.id + 1;
+    }
+
+    // 3. Then build the queue in one pass (one forest, no per-patient root-list growth)
+    queue.insertMany(rows, count);
+    delete[] rows;
+
+    if (header.nextId > nextId) nextId = header.nextId;
+    return true;
+}
+
+bool Snapshot::isSnapshot(std::string filename) {
+    FILE* file = fopen(filename.c_str(), "rb");
+    if (file == nullptr) return false;
+
+    char magic[4];
+    bool match = fread(magic, 1, 4, file) == 4 && memcmp(magic, SNAPSHOT_MAGIC, 4) == 0;
+    fclose(file);
+    return match;
+}
@@ -0,0 +1,64 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <cstdint>
+#include "TriageQueue.h"
+
+// Binary snapshot of the waiting room (patients_data.bin)
+//
+// Layout (little-endian, fixed-size fields):
+//   SnapshotHeader
+//   count x { SnapshotRecord, name bytes, description bytes }
+//
+// Strings are length-prefixed, so names may contain spaces.
+// Loading maps the file and reads the records in place.
+
+const char SNAPSHOT_MAGIC[4] = { 'T', 'R', 'I', 'G' };
+const uint32_t SNAPSHOT_VERSION = 2;    // v2 added SnapshotRecord::arrival
+
+#pragma pack(push, 1)
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t count;     // Number of records that follow
+    int64_t nextId;     // System's auto-increment counter at save time
+};
+
+struct SnapshotRecord {
+    int64_t id;
+    int32_t priority;
+    int32_t age;
+    int64_t arrival;    // Microseconds since the epoch (queue order within a level)
+    uint32_t nameLen;
+    uint32_t descLen;
+};
+
+// Version 1 record (no arrival). Still read on load; the write-ahead log
+// reuses this layout and appends the arrival after the strings.
+struct SnapshotRecordV1 {
+    int64_t id;
+    int32_t priority;
+    int32_t age;
+    uint32_t nameLen;
+    uint32_t descLen;
+};
+#pragma pack(pop)
+
+class Snapshot {
+public:
+    // Writes the whole queue to 'filename' (via a .tmp file, see replaceFile(),
+    // so neither a crash nor a power cut mid-write loses the last snapshot).
+    // true = the new snapshot is on disk: what it holds may be dropped from the log.
+    static bool save(TriageQueue& queue, long long nextId, std::string filename);
+
+    // Bulk-loads a snapshot into 'queue' (pool and index are sized up front).
+    // Version 1 files load too; their patients are stamped in file order.
+    // Returns false if the file is missing, truncated or not a snapshot.
+    static bool load(TriageQueue& queue, long long& nextId, std::string filename);
+
+    // True if the file starts with the snapshot magic
+    static bool isSnapshot(std::string filename);
+};
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Lock-free single-producer / single-consumer ring buffer.
+// Exactly one thread may push and exactly one (other) thread may pop.
+// Capacity is a power of two; head and tail only ever grow, so
+// "tail - head" is the fill level and indices are masked on access.
+template <typename T>
+class SpscRing {
+private:
+    T* slots;
+    size_t mask;
+
+    // Written by one side, read by the other; kept on separate cache lines
+    alignas(64) std::atomic<size_t> head; // Next slot to pop (consumer)
+    alignas(64) std::atomic<size_t> tail; // Next slot to fill (producer)
+
+    // Non-copyable: owns the slots
+    SpscRing(const SpscRing&);
+    SpscRing& operator=(const SpscRing&);
+
+public:
+    explicit SpscRing(size_t capacity) : head(0), tail(0) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        slots = new T[size];
+        mask = size - 1;
+    }
+
+    ~SpscRing() {
+        delete[] slots;
+    }
+
+    // Producer side. Returns false if the ring is full (nothing is moved).
+    bool tryPush(T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false;
+
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release); // Publish the filled slot
+        return true;
+    }
+
+    // Producer side. Waits (briefly sleeping) while the consumer catches up.
+    void push(T& value) {
+        while (!tryPush(value)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool tryPop(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+
+        out = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release); // Hand the slot back
+        return true;
+    }
+
+    // Either side (a snapshot: may be stale by the time it returns)
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+// Wakes a sleeping consumer when a producer has pushed something.
+// The consumer spins for a moment first, so a busy pipeline never touches the
+// mutex; producers only take it when the consumer is actually asleep.
+class Doorbell {
+private:
+    std::mutex lock;
+    std::condition_variable cv;
+    std::atomic<bool> sleeping;
+
+    Doorbell(const Doorbell&);
+    Doorbell& operator=(const Doorbell&);
+
+public:
+    Doorbell() : sleeping(false) {}
+
+    // Producer: call after every push
+    void ring() {
+        // Pairs with the fence in wait(): either we see 'sleeping', or the
+        // consumer sees our push when it re-checks its condition
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> guard(lock);
+            cv.notify_all();
+        }
+    }
+
+    // Consumer: returns once ready() is true
+    template <typename Pred>
+    void wait(Pred ready) {
+        // 1. Busy phase: work usually arrives in bursts
+        for (int spin = 0; spin < 256; spin++) {
+            if (ready()) return;
+            std::this_thread::yield();
+        }
+
+        // 2. Idle phase: sleep until a producer rings
+        std::unique_lock<std::mutex> guard(lock);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!ready()) {
+            // The timeout is only a safety net; ring() normally wakes us
+            cv.wait_for(guard, std::chrono::milliseconds(50));
+        }
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    // Consumer: like wait(), but gives up after 'millis'. Returns ready().
+    template <typename Pred>
+    bool waitFor(Pred ready, int millis) {
+        for (int spin = 0; spin < 256; spin++) {
+            if (ready()) return true;
+            std::this_thread::yield();
+        }
+
+        std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(millis);
+        std::unique_lock<std::mutex> guard(lock);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool done;
+        while (!(done = ready()) && std::chrono::steady_clock::now() < deadline) {
+            cv.wait_until(guard, std::min(deadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(50)));
+        }
+        sleeping.store(false, std::memory_order_relaxed);
+        return done;
+    }
+};
+
+#endif
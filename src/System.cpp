@@ -1,99 +1,727 @@
 #include "System.h"
+#include "WireProtocol.h"
+#include "Manifest.h"
 #include <iostream>
-#include <fstream>
 #include <sstream>
+#include <thread>
+#include <cstddef>
+#include <chrono>
+#include <utility>
 
 
-System::System() {
-    isLoggedIn = false;
+System::System(const std::string& engine, int agingScale, int authCost, const std::string& queues) {
+    auth.setCost(authCost);
+    consoleLoggedIn = false;
+    isLoggedIn = &consoleLoggedIn;
+    pipeline = nullptr;
+    serving = false;
+    statsRevision = 0;
     nextId = 1; 
 
-    // We try to open the database file. If it exists, we rebuild the heap.
-    std::ifstream file("patients_data.txt");
-    if (file.is_open()) {
-        int id, prio, age;
-        std::string name, desc;
-        
-        // Read line by line: [ID] [PRIORITY] [AGE] [NAME] [DESC]
-        while (file >> id >> prio >> age >> name >> desc) {
-            heap.insert(id, prio, age, name, desc);
+    TriageQueue* main = TriageQueue::create(engine);
+    if (main == nullptr) {
+        std::cerr << "Unknown queue engine '" << engine << "', using fib\n";
+        main = TriageQueue::create("fib");
+    }
 
+    // Department 0 is "main"; the others come from --queues (comma-separated)
+    queue = new DepartmentQueue(main);
+    size_t start = 0;
+    while (start < queues.size()) {
+        size_t comma = queues.find(',', start);
+        if (comma == std::string::npos) comma = queues.size();
+        std::string name = queues.substr(start, comma - start);
+        if (!name.empty() && !queue->addDepartment(name)) {
+            std::cerr << "Ignoring queue '" << name << "' (bad or repeated name, or too many queues)\n";
+        }
+        start = comma + 1;
+    }
+
+    // 1. Fast path: bulk-load the binary snapshot.
+    // It is loaded into a scratch queue first, so a damaged file leaves nothing behind;
+    // merging into the empty main queue is O(1).
+    TriageQueue* loaded = queue->createEmpty();
+    long long collidingId;
+    if (Snapshot::load(*loaded, nextId, SNAPSHOT_FILE)) {
+        queue->merge(*loaded, collidingId);
+    }
+    else {
+        // 2. Fallback: rebuild from the legacy text file (first start after upgrading)
+        long long maxId = 0;
+        TriageQueue* imported = queue->createEmpty();
+        if (Manifest::load(*imported, maxId, TEXT_FILE)) {
+            queue->merge(*imported, collidingId);
             // Ensure our auto-increment ID is always higher than the highest loaded ID
-            if (id >= nextId) {
-                nextId = id + 1;
+            if (maxId >= nextId) nextId = maxId + 1;
+        }
+        delete imported;
+    }
+    delete loaded;
+
+    // Everyone was loaded into "main": move the others back to their departments
+    queue->loadAssignments(DEPARTMENTS_FILE);
+
+    // 3. Crash recovery: replay whatever was logged after that snapshot,
+    // then fold it into a fresh snapshot so the log starts empty again.
+    wal.open(WAL_FILE);
+    if (!wal.isEmpty()) {
+        wal.replay(*queue, nextId);
+        checkpoint();
+    }
+
+    // 4. Restart everyone's wait clock from their arrival time, and start the
+    // audit history with the queue as it was recovered
+    aging.setScale(agingScale);
+    queue->forEachPatient([this](const TriageEntry& e) {
+        aging.arm(e.id, e.priority, e.arrival);
+        audit.put(e.id, e.priority, e.record->age, e.arrival, e.record->name, e.record->description);
+    });
+    audit.publish();
+
+    // 5. First STATS view (count -1 forces the percentile walk)
+    stats.count = -1;
+    publishStats();
+}
+
+System::~System() {
+    delete queue;
+}
+
+bool System::checkpoint() {
+    // Departments first. If we crash before the snapshot is in, the old snapshot
+    // and the whole log are still there, and replaying the log's transfers on
+    // top of the newer assignments puts every patient where they were.
+    if (!queue->saveAssignments(DEPARTMENTS_FILE)) return false;
+
+    // Only drop the log once the snapshot holding its changes, and its
+    // directory entry, are on disk (save() returns after both are synced)
+    if (!Snapshot::save(*queue, nextId, SNAPSHOT_FILE)) return false;
+    wal.reset();
+    return true;
+}
+
+void System::runAging() {
+    // Only the patients whose deadline passed are touched.
+    // Escalations are the backend's own decision: they are not journaled for UNDO.
+    aging.advance([this](long long id, int priority) {
+        int escalated = priority - 1;
+        if (!queue->updatePriority(id, escalated)) return;
+
+        wal.logUpdate(id, escalated);
+        feed.recordEscalate(id, escalated);
+        aging.arm(id, escalated, ARRIVAL_NOW); // New level, new wait limit
+        audit.setPriority(id, escalated);
+    });
+
+    // At most one audit image a minute, and only when something changed
+    audit.publish();
+}
+
+// Text ADDs are held to what a binary reply can carry (WirePatient's 16-bit lengths)
+static bool fitsTextLimit(const std::string& name, const std::string& desc) {
+    return name.size() <= (size_t)MAX_TEXT_LENGTH && desc.size() <= (size_t)MAX_TEXT_LENGTH;
+}
+
+// After a number failed to parse: the stream (the console's persistent one
+// included) is usable again and the rest of the bad line is skipped
+static void skipBadLine(std::istream& in) {
+    in.clear();
+    std::string garbage;
+    std::getline(in, garbage);
+}
+
+// DATA line of EXTRACT, plus the department the patient was waiting in
+static void writeDepartmentData(std::ostream& out, const TriageEntry& n, const std::string& department) {
+    out << "DATA " << n.id << " "
+        << n.priority << " "
+        << n.record->age << " "
+        << textField(n.record->name) << " "
+        << textField(n.record->description) << " "
+        << department << "\n";
+}
+
+// Everything UNDO needs to put a patient back exactly where they were
+static void keepPatient(PatientRow& row, const TriageEntry& e) {
+    row.id = e.id;
+    row.priority = e.priority;
+    row.age = e.record->age;
+    row.arrival = e.arrival;
+    row.name = e.record->name;
+    row.description = e.record->description;
+}
+
+long long System::admitPatient(int priority, int age, const std::string& name, const std::string& desc,
+                               int department, const char* command) {
+    long long id = nextId++;
+    queue->insertInto(department, id, priority, age, name, desc);
+    aging.arm(id, priority, ARRIVAL_NOW);
+
+    // Logged with its arrival, so a replayed patient keeps their place in line
+    TriageEntry added;
+    queue->find(id, added);
+    wal.logAdd(id, priority, age, name, desc, added.arrival);
+    if (department != 0) wal.logTransfer(id, queue->departmentName(department));
+    feed.recordAdd(id, priority, age, name, desc);
+    audit.put(id, priority, age, added.arrival, name, desc);
+    journal.record(UNDO_ADDED, command, 1).patients[0].id = id;
+    return id;
+}
+
+bool System::treatNext(TriageEntry& out, int& department, const char* command) {
+    bool found = (department == ANY_DEPARTMENT) ? queue->extractAny(out, department)
+                                                : queue->extractFrom(department, out);
+    if (!found) return false;
+    wal.logExtract(out.id);
+    feed.recordRemove(out.id);
+    aging.cancel(out.id);
+    audit.erase(out.id);
+
+    UndoStep& step = journal.record(UNDO_REMOVED, command, 1);
+    step.treated = true;
+    step.waitMinutes = waits.recordTreatment(out.priority, out.arrival);
+    keepPatient(step.patients[0], out);
+    step.departments[0] = department;
+    return true;
+}
+
+bool System::retriage(long long id, int priority) {
+    TriageEntry before;
+    if (!queue->find(id, before)) return false;
+    if (!queue->updatePriority(id, priority)) return false;
+    wal.logUpdate(id, priority);
+    feed.recordUpdate(id, priority);
+    aging.arm(id, priority, ARRIVAL_NOW); // Re-triaged: the wait limit starts over
+    audit.setPriority(id, priority);
+
+    UndoStep& step = journal.record(UNDO_UPDATED, "UPDATE", 1);
+    step.patients[0].id = id;
+    step.fromPriority = before.priority;
+    step.toPriority = priority;
+    return true;
+}
+
+bool System::leavePatient(long long id) {
+    // The record goes with the patient: keep a copy for UNDO first
+    TriageEntry leaving;
+    if (!queue->find(id, leaving)) return false;
+    UndoStep& step = journal.record(UNDO_REMOVED, "LEAVE", 1);
+    keepPatient(step.patients[0], leaving);
+    step.departments[0] = queue->departmentOf(id);
+
+    queue->removePatient(id);
+    wal.logLeave(id);
+    feed.recordRemove(id);
+    aging.cancel(id);
+    audit.erase(id);
+    return true;
+}
+
+bool System::transferPatient(long long id, int department) {
+    int from = queue->departmentOf(id);
+    if (from < 0 || !queue->transfer(id, department)) return false;
+    if (from == department) return true; // Already there: nothing to log or undo
+
+    // Same patient, same wait clock and audit row: only the department changes
+    wal.logTransfer(id, queue->departmentName(department));
+
+    UndoStep& step = journal.record(UNDO_MOVED, "TRANSFER", 1);
+    step.patients[0].id = id;
+    step.fromDepartment = from;
+    step.toDepartment = department;
+    return true;
+}
+
+bool System::invertStep(UndoStep& step, long long& conflictId) {
+    // 1. Check every patient first, so a step is inverted whole or not at all:
+    // taking patients out needs them queued, putting them back needs them gone
+    bool wantQueued = (step.kind != UNDO_REMOVED);
+    for (int i = 0; i < step.count; i++) {
+        TriageEntry e;
+        if (queue->find(step.patients[i].id, e) != wantQueued) {
+            conflictId = step.patients[i].id;
+            return false;
+        }
+    }
+
+    // 2. Apply the opposite through the same updates the commands make
+    if (step.kind == UNDO_ADDED) {
+        for (int i = 0; i < step.count; i++) {
+            PatientRow& row = step.patients[i];
+            TriageEntry e;
+            queue->find(row.id, e);
+            keepPatient(row, e); // Whatever happened since (escalations) is kept for REDO
+            step.departments[i] = queue->departmentOf(row.id);
+            queue->removePatient(row.id);
+
+            if (step.treated) {
+                // REDO of an EXTRACT: treated again, so their wait counts again
+                wal.logExtract(row.id);
+                step.waitMinutes = waits.recordTreatment(row.priority, row.arrival);
+            } else {
+                wal.logLeave(row.id);
             }
+            feed.recordRemove(row.id);
+            aging.cancel(row.id);
+            audit.erase(row.id);
+        }
+        step.kind = UNDO_REMOVED;
+    } else if (step.kind == UNDO_REMOVED) {
+        // Same ID, department and original arrival: the patient gets their place
+        // in line back. Their node and record come off the engine's free lists.
+        for (int i = 0; i < step.count; i++) {
+            PatientRow& row = step.patients[i];
+            int department = step.departments[i];
+            wal.logRestore(row.id, row.priority, row.age, row.name, row.description, row.arrival);
+            if (department != 0) wal.logTransfer(row.id, queue->departmentName(department));
+            feed.recordAdd(row.id, row.priority, row.age, row.name, row.description);
+            audit.put(row.id, row.priority, row.age, row.arrival, row.name, row.description);
+            aging.arm(row.id, row.priority, row.arrival);
+            if (step.treated) waits.forgetTreatment(row.priority, step.waitMinutes);
+            queue->insertInto(department, row.id, row.priority, row.age, std::move(row.name),
+                              std::move(row.description), row.arrival);
         }
-        file.close();
+        step.kind = UNDO_ADDED;
+    } else if (step.kind == UNDO_MOVED) {
+        long long id = step.patients[0].id;
+        int department = step.fromDepartment;
+        queue->transfer(id, department);
+        wal.logTransfer(id, queue->departmentName(department));
+
+        step.fromDepartment = step.toDepartment;
+        step.toDepartment = department;
+    } else {
+        long long id = step.patients[0].id;
+        int priority = step.fromPriority;
+        queue->updatePriority(id, priority);
+        wal.logUpdate(id, priority);
+        feed.recordUpdate(id, priority);
+        aging.arm(id, priority, ARRIVAL_NOW);
+        audit.setPriority(id, priority);
+
+        step.fromPriority = step.toPriority;
+        step.toPriority = priority;
     }
+    return true;
+}
+
+bool System::commitLog() {
+    bool logged = wal.commit();
+    if (!logged) std::cerr << "Write-ahead log write failed; the changes stay buffered" << std::endl;
+
+    // A snapshot holds everything the log could not take, so it also covers a failed write
+    if (!logged || wal.needsCompaction()) {
+        if (checkpoint()) logged = true;
+    }
+    return logged;
+}
+
+bool System::loadPatientFile(const std::string& filename, TriageQueue& target, long long& maxId) {
+    if (Snapshot::isSnapshot(filename)) {
+        long long snapshotNextId = 0;
+        if (!Snapshot::load(target, snapshotNextId, filename)) return false;
+        if (snapshotNextId - 1 > maxId) maxId = snapshotNextId - 1;
+        return true;
+    }
+    return Manifest::load(target, maxId, filename);
 }
 
 void System::run() {
+    // 1. Start the reader and writer around this (owner) thread
+    pipeline = new Pipeline();
+    pipeline->audit = &audit;
+    pipeline->idle = this;
+    publishStats();
+    std::thread reader(runReader, std::ref(*pipeline), std::ref(std::cin));
+    std::thread writer(runWriter, std::ref(*pipeline), std::ref(std::cout));
+
+    PipelineInputBuf source(*pipeline);
+    std::istream commands(&source);
     std::string command;
 
     // --- MAIN LOOP ---
-    // Waits for text commands from Python via Standard Input (std::cin)
-    while (std::cin >> command) {
-        
-        // 1. LOGIN COMMAND (Public)
-        // Format: LOGIN <username> <password>
-        if (command == "LOGIN") {
-            std::string user, pass;
-            std::cin >> user >> pass;
-            
-            if (auth.login(user, pass)) {
-                isLoggedIn = true;
-                std::cout << "SUCCESS_LOGIN" << std::endl;
-            } else {
-                std::cout << "ERROR_LOGIN" << std::endl;
-            }
+    // Commands arrive through the reader thread, in the order Python sent them
+    while (commands >> command) {
+
+        // Apply due escalations first, so this command sees the current queue
+        runAging();
+
+        // Each command's reply is collected here and handed to the writer in one piece
+        std::ostringstream reply;
+
+        // BATCH FRAMING: run a whole block, answer with one write
+        // Format: BEGIN <cmd> ... END   or   BATCH <n> <cmd 1> ... <cmd n>
+        bool keepRunning;
+        if (command == "BEGIN" || command == "BATCH") {
+            keepRunning = runBatch(command, commands, reply);
+        } else {
+            keepRunning = execute(command, commands, reply);
         }
-        
-        // 2. CHANGE PASSWORD (Public)
-        // Format: CHANGE_PASS <username> <old_pass> <new_pass>
-        else if (command == "CHANGE_PASS") {
-            std::string user, oldPass, newPass;
-            std::cin >> user >> oldPass >> newPass;
-            
-            if (auth.changePassword(user, oldPass, newPass)) {
-                std::cout << "SUCCESS_PASS_CHANGE" << std::endl;
-            } else {
-                std::cout << "ERROR_PASS_CHANGE" << std::endl;
-            }
+
+        // Log before acknowledging: a reply the GUI has seen is never lost
+        if (!commitLog()) reply << "ERROR_LOG_WRITE" << std::endl;
+        publishStats();
+
+        std::string text = reply.str();
+        pipeline->replies.push(text);
+        source.replied();
+        pipeline->outputBell.ring();
+        if (!keepRunning) break; // EXIT: Terminate the C++ backend
+    }
+
+    // 2. Let the writer send what is left, then shut down
+    pipeline->ownerDone.store(true, std::memory_order_release);
+    pipeline->outputBell.ring();
+    writer.join();
+
+    if (pipeline->inputClosed.load(std::memory_order_acquire)) {
+        reader.join();
+        delete pipeline;
+    } else {
+        // The reader is blocked on stdin (EXIT came in a way it could not see).
+        // It cannot be interrupted portably; the process is about to end, so it
+        // keeps the pipeline.
+        reader.detach();
+    }
+    pipeline = nullptr;
+}
+
+bool System::serve(const std::string& address) {
+    SocketServer server;
+    if (!server.listen(address)) return false;
+    std::cerr << "Serving on " << address << "\n";
+
+    serving = true;
+    server.run(*this);
+    serving = false;
+
+    // Stopped by a signal: leave a complete snapshot behind
+    if (!checkpoint()) wal.flush();
+    return true;
+}
+
+bool System::runText(std::istream& in, std::ostream& out) {
+    std::string command;
+    bool keepSession = true;
+    while (keepSession && in >> command) {
+        runAging();
+        if (command == "BEGIN" || command == "BATCH") {
+            keepSession = runBatch(command, in, out);
+        } else {
+            keepSession = execute(command, in, out);
+        }
+    }
+    return keepSession;
+}
+
+bool System::handleCommands(const std::string& unit, bool& loggedIn, std::string& reply) {
+    // Commands run with this client's login state
+    isLoggedIn = &loggedIn;
+
+    std::istringstream in(unit);
+    std::ostringstream out;
+    bool keepSession = runText(in, out);
+
+    // Log before acknowledging, exactly like the console loop
+    if (!commitLog()) out << "ERROR_LOG_WRITE" << std::endl;
+    isLoggedIn = &consoleLoggedIn;
+
+    reply += out.str();
+    return keepSession; // EXIT ends this session, not the server
+}
+
+// WIRE_ADD strings: non-empty and free of control bytes. Spaces are fine
+// (text replies write them as '_', see textField()); a tab or newline is not.
+static bool isWireText(const char* s, uint16_t n) {
+    if (n == 0) return false;
+    for (uint16_t i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c < ' ' || c == 0x7f) return false;
+    }
+    return true;
+}
+
+// Patient record as sent in binary responses: fixed part, then the two strings
+static void appendPatient(std::string& out, const TriageEntry& e) {
+    WirePatient patient;
+    patient.id = e.id;
+    patient.arrival = e.arrival;
+    patient.priority = e.priority;
+    patient.age = e.record->age;
+    patient.nameLen = (uint16_t)e.record->name.size();
+    patient.descLen = (uint16_t)e.record->description.size();
+    appendStruct(out, patient);
+    out.append(e.record->name.data(), patient.nameLen);
+    out.append(e.record->description.data(), patient.descLen);
+}
+
+bool System::handleFrame(const char* frame, size_t length, bool& loggedIn, std::string& reply) {
+    // 1. Header (the server only hands over complete frames)
+    WireHeader header;
+    memcpy(&header, frame, sizeof(header));
+    WireReader payload(frame + sizeof(WireHeader), length - sizeof(WireHeader));
+
+    isLoggedIn = &loggedIn;
+    runAging();
+
+    // 2. The response echoes opcode and tag; its status is patched in below
+    size_t start = beginFrame(reply, header.opcode, WIRE_OK, header.tag);
+    uint16_t status = WIRE_OK;
+    bool keepSession = true;
+
+    bool isPublic = header.opcode == WIRE_PING || header.opcode == WIRE_LOGIN || header.opcode == WIRE_EXIT;
+    if (!isPublic && !loggedIn) {
+        status = WIRE_AUTH;
+    }
+    else if (header.opcode == WIRE_PING) {
+        // Nothing to do: the empty OK frame is the pong
+    }
+    else if (header.opcode == WIRE_LOGIN) {
+        WireLogin login;
+        const char* user;
+        const char* pass;
+        if (!payload.read(login) || !payload.bytes(login.userLen, user) || !payload.bytes(login.passLen, pass)) {
+            status = WIRE_BAD_REQUEST;
+        } else if (auth.login(std::string(user, login.userLen), std::string(pass, login.passLen))) {
+            loggedIn = true;
+        } else {
+            status = WIRE_LOGIN_FAILED;
+        }
+    }
+    else if (header.opcode == WIRE_ADD) {
+        WireAdd add;
+        const char* name;
+        const char* desc;
+        if (!payload.read(add) || !payload.bytes(add.nameLen, name) || !payload.bytes(add.descLen, desc) ||
+            add.priority < MIN_PRIORITY || add.priority > MAX_PRIORITY ||
+            !isWireText(name, add.nameLen) || !isWireText(desc, add.descLen)) {
+            status = WIRE_BAD_REQUEST;
+        } else {
+            int64_t id = admitPatient(add.priority, add.age, std::string(name, add.nameLen),
+                                      std::string(desc, add.descLen));
+            appendStruct(reply, id);
+        }
+    }
+    else if (header.opcode == WIRE_EXTRACT || header.opcode == WIRE_PEEK) {
+        TriageEntry e;
+        int department = 0;
+        bool found = (header.opcode == WIRE_EXTRACT) ? treatNext(e, department) : queue->peek(e);
+        if (found) {
+            appendPatient(reply, e);
+        } else {
+            status = WIRE_EMPTY;
+        }
+    }
+    else if (header.opcode == WIRE_UPDATE) {
+        WireUpdate update;
+        if (!payload.read(update) || update.priority < MIN_PRIORITY || update.priority > MAX_PRIORITY) {
+            status = WIRE_BAD_REQUEST;
+        } else if (!retriage(update.id, update.priority)) {
+            status = WIRE_NOT_FOUND;
+        }
+    }
+    else if (header.opcode == WIRE_LEAVE) {
+        int64_t id;
+        if (!payload.read(id)) {
+            status = WIRE_BAD_REQUEST;
+        } else if (!leavePatient(id)) {
+            status = WIRE_NOT_FOUND;
+        }
+    }
+    else if (header.opcode == WIRE_STATS) {
+        publishStats();
+        WireStats out;
+        out.count = stats.count;
+        out.levels = MAX_PRIORITY + 1;
+        for (int level = 0; level <= MAX_PRIORITY; level++) {
+            out.treated[level] = stats.levels[level].treated;
+            out.p50[level] = stats.levels[level].p50;
+            out.p90[level] = stats.levels[level].p90;
+            out.p99[level] = stats.levels[level].p99;
+        }
+        appendStruct(reply, out);
+    }
+    else if (header.opcode == WIRE_TOPK) {
+        int32_t k;
+        if (!payload.read(k) || k <= 0) {
+            status = WIRE_BAD_REQUEST;
+        } else {
+            // The count goes first but is only known afterwards: reserve and patch
+            size_t countAt = reply.size();
+            appendStruct(reply, (uint32_t)0);
+            uint32_t n = (uint32_t)queue->forEachTopK(k, [&reply](const TriageEntry& e) {
+                appendPatient(reply, e);
+            });
+            memcpy(&reply[countAt], &n, sizeof(n));
+        }
+    }
+    else if (header.opcode == WIRE_TEXT) {
+        // Escape hatch for the commands without a binary form (LIST, MERGE, ...)
+        std::istringstream in(std::string(frame + sizeof(WireHeader), length - sizeof(WireHeader)));
+        std::ostringstream out;
+        keepSession = runText(in, out);
+        reply += out.str();
+    }
+    else if (header.opcode == WIRE_EXIT) {
+        // Only this session ends (see the text EXIT)
+        keepSession = false;
+    }
+    else {
+        status = WIRE_BAD_REQUEST;
+    }
+
+    // 3. Log before the frame can be sent, then finish it
+    if (!commitLog() && status == WIRE_OK) status = WIRE_LOG_FAILED;
+    memcpy(&reply[start + offsetof(WireHeader, status)], &status, sizeof(status));
+    endFrame(reply, start);
+
+    isLoggedIn = &consoleLoggedIn;
+    return keepSession;
+}
+
+void System::onIdle() {
+    // Escalations keep coming while no client is talking
+    runAging();
+    commitLog();
+}
+
+void System::publishStats() {
+    int count = queue->getNumNodes();
+    long long revision = waits.getRevision();
+    bool recompute = (stats.count < 0) || (revision != statsRevision);
+    bool changed = (count != stats.count) || recompute;
+
+    // The percentile walk only runs when a treatment was recorded (or undone)
+    if (recompute) {
+        for (int level = 0; level <= MAX_PRIORITY; level++) {
+            stats.levels[level] = waits.summary(level);
+        }
+        statsRevision = revision;
+    }
+    stats.count = count;
+
+    if (pipeline != nullptr) {
+        if (changed) pipeline->stats.publish(stats);
+        pipeline->loggedIn.store(consoleLoggedIn, std::memory_order_release);
+    }
+}
+
+bool System::runBatch(const std::string& frame, std::istream& in, std::ostream& out) {
+    // Responses collect in memory and go out in one write at the end
+    std::ostringstream buffer;
+    bool keepRunning = true;
+    int executed = 0;
+
+    int limit = -1; // -1 = until END
+    if (frame == "BATCH") {
+        in >> limit;
+        if (!in || limit < 0) {
+            in.clear();
+            std::string garbage; std::getline(in, garbage);
+            out << "ERROR_BATCH_SIZE\n";
+            return true;
         }
+    }
+
+    std::string command;
+    while ((limit < 0 || executed < limit) && in >> command) {
+        if (limit < 0 && command == "END") break;
+
+        if (command == "BEGIN" || command == "BATCH") {
+            // Nested frames are not supported; treat as an unknown command
+            buffer << "ERROR_NESTED_BATCH\n";
+            std::string garbage; std::getline(in, garbage);
+        }
+        else if (!execute(command, in, buffer)) {
+            keepRunning = false; // EXIT inside the batch: stop after this write
+            executed++;
+            break;
+        }
+        executed++;
+    }
+
+    // One write for the whole block (the caller flushes once)
+    buffer << "BATCH_END " << executed << "\n";
+    out << buffer.str();
+    return keepRunning;
+}
+
+bool System::execute(const std::string& command, std::istream& in, std::ostream& out) {
+#if TRIAGE_METRICS
+    // Time spent in the backend only: pipe, reader and writer are not included
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    bool keepRunning = dispatch(command, in, out);
+    long long nanos = (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    metrics.record(CommandMetrics::commandIndex(command), nanos);
+    return keepRunning;
+#else
+    return dispatch(command, in, out);
+#endif
+}
 
-        // 3. EXIT COMMAND (Always allowed)
-        else if (command == "EXIT") {
-            heap.saveToFile("patients_data.txt");
-            std::cout << "SUCCESS_EXIT" << std::endl;
-            break; // Terminate the C++ backend
+bool System::dispatch(const std::string& command, std::istream& in, std::ostream& out) {
+
+    // 1. LOGIN COMMAND (Public)
+    // Format: LOGIN <username> <password>
+    if (command == "LOGIN") {
+        std::string user, pass;
+        in >> user >> pass;
+        
+        if (auth.login(user, pass)) {
+            *isLoggedIn = true;
+            out << "SUCCESS_LOGIN\n";
+        } else {
+            out << "ERROR_LOGIN\n";
         }
+    }
+    
+    // 2. CHANGE PASSWORD (Public)
+    // Format: CHANGE_PASS <username> <old_pass> <new_pass>
+    else if (command == "CHANGE_PASS") {
+        std::string user, oldPass, newPass;
+        in >> user >> oldPass >> newPass;
         
-        // 4. PING (Heartbeat check for Python)
-        else if (command == "PING") {
-            std::cout << "PONG" << std::endl;
+        if (auth.changePassword(user, oldPass, newPass)) {
+            out << "SUCCESS_PASS_CHANGE\n";
+        } else {
+            out << "ERROR_PASS_CHANGE\n";
         }
+    }
+
+    // 3. EXIT COMMAND (Always allowed)
+    else if (command == "EXIT") {
+        // Console: the backend stops, so snapshot everything (if that fails
+        // the log still has it all). Server: only this session ends, and
+        // checkpoints stay with shutdown and log compaction, so no client
+        // (logged in or not) can make the poll thread write snapshots.
+        if (!serving && !checkpoint()) wal.flush();
+        out << "SUCCESS_EXIT\n";
+        return false;
+    }
+    
+    // 4. PING (Heartbeat check for Python)
+    else if (command == "PING") {
+        out << "PONG\n";
+    }
 
-        // 5. RESTRICTED COMMANDS (Must be Logged In)
+    // 5. RESTRICTED COMMANDS (Must be Logged In)
+    else {
+        if (!*isLoggedIn) {
+            // If not logged in, consume arguments to prevent stream desync.
+            // Otherwise, the next word in the buffer might be interpreted as a command.
+            std::string garbage;
+            std::getline(in, garbage);
+            out << "ERROR_AUTH\n";
+        }
         else {
-            if (!isLoggedIn) {
-                // If not logged in, consume arguments to prevent stream desync.
-                // Otherwise, the next word in the buffer might be interpreted as a command.
-                std::string garbage;
-                std::getline(std::cin, garbage);
-                std::cout << "ERROR_AUTH" << std::endl;
-            }
-            else {
-                // User is logged in, process the actual medical operations
-                processCommand(command);
-            }
+            // User is logged in, process the actual medical operations
+            processCommand(command, in, out);
         }
-
-        // CRITICAL: Flush output so Python receives it immediately
-        std::cout.flush();
     }
+    return true;
 }
 
-void System::processCommand(std::string cmd) {
+void System::processCommand(const std::string& cmd, std::istream& in, std::ostream& out) {
     
     // --- ADD PATIENT ---
     if (cmd == "ADD") {
@@ -101,114 +729,465 @@ void System::processCommand(std::string cmd) {
         std::string name, desc;
         // Expects: ADD [PRIORITY] [AGE] [NAME] [DESC]
         // Note: nextId is generated automatically
-        std::cin >> prio >> age >> name >> desc;
+        in >> prio >> age >> name >> desc;
 
-        if (prio < 1 || prio > 10) {
-            std::cout << "ERROR: Priority must be 1-10" << std::endl;
+        if (prio < MIN_PRIORITY || prio > MAX_PRIORITY) {
+            out << "ERROR: Priority must be 1-10\n";
             return;
         }
-        
-        heap.insert(nextId, prio, age, name, desc);
-        std::cout << "SUCCESS_ADD " << name << " ID:" << nextId << std::endl;
-        
-        nextId++; 
+        if (!fitsTextLimit(name, desc)) {
+            out << "ERROR: Name and description must be at most 65535 bytes\n";
+            return;
+        }
+
+        long long id = admitPatient(prio, age, name, desc);
+        out << "SUCCESS_ADD " << name << " ID:" << id << "\n";
     }
     
     // --- EXTRACT (Treat Next Patient) ---
     else if (cmd == "EXTRACT") {
-        Node* n = heap.extractMin();
-        if (n) {
+        TriageEntry n;
+        int department = 0;
+        if (treatNext(n, department)) {
             // Output: DATA [ID] [PRIO] [AGE] [NAME] [DESC]
-            std::cout << "DATA " << n->id << " " 
-                      << n->priority << " " 
-                      << n->age << " "
-                      << n->name << " " 
-                      << n->description << std::endl;
-
-            // CRITICAL: Prevent memory leak by deleting the extracted node
-            delete n;
+            // NOTE: The record is owned by the queue, no delete here
+            out << "DATA " << n.id << " " 
+                      << n.priority << " " 
+                      << n.record->age << " "
+                      << textField(n.record->name) << " " 
+                      << textField(n.record->description) << "\n";
         } else {
-            std::cout << "EMPTY" << std::endl;
+            out << "EMPTY\n";
         }
     }
     
     // --- PEEK (View Next Patient) ---
     else if (cmd == "PEEK") {
-        Node* minNode = heap.peek();
-        if (minNode) {
-            std::cout << "DATA " << minNode->id << " " 
-                      << minNode->priority << " " 
-                      << minNode->age << " "
-                      << minNode->name << " " 
-                      << minNode->description << std::endl;
+        TriageEntry top;
+        if (queue->peek(top)) {
+            out << "DATA " << top.id << " " 
+                      << top.priority << " " 
+                      << top.record->age << " "
+                      << textField(top.record->name) << " " 
+                      << textField(top.record->description) << "\n";
+        } else {
+            out << "EMPTY\n";
+        }
+    }
+
+    // --- QUEUES (The Department Queues) ---
+    // Output: QUEUE <name> <waiting> per department ("main" first), then QUEUES_END <n>
+    else if (cmd == "QUEUES") {
+        int count = queue->departmentCount();
+        for (int d = 0; d < count; d++) {
+            out << "QUEUE " << queue->departmentName(d) << " " << queue->department(d).getNumNodes() << "\n";
+        }
+        out << "QUEUES_END " << count << "\n";
+    }
+
+    // --- ADD_TO (Admit Straight into a Department) ---
+    // Expects: ADD_TO [QUEUE] [PRIORITY] [AGE] [NAME] [DESC]. Same reply as ADD.
+    else if (cmd == "ADD_TO") {
+        std::string name, desc, department;
+        int prio, age;
+        in >> department >> prio >> age >> name >> desc;
+
+        int d = queue->findDepartment(department);
+        if (d < 0) {
+            out << "ERROR_UNKNOWN_QUEUE " << department << "\n";
+            return;
+        }
+        if (prio < MIN_PRIORITY || prio > MAX_PRIORITY) {
+            out << "ERROR: Priority must be 1-10\n";
+            return;
+        }
+        if (!fitsTextLimit(name, desc)) {
+            out << "ERROR: Name and description must be at most 65535 bytes\n";
+            return;
+        }
+
+        long long id = admitPatient(prio, age, name, desc, d, "ADD_TO");
+        out << "SUCCESS_ADD " << name << " ID:" << id << "\n";
+    }
+
+    // --- EXTRACT_FROM (Treat the Next Patient of One Department) ---
+    // Output: DATA [ID] [PRIO] [AGE] [NAME] [DESC] [QUEUE] | EMPTY | ERROR_UNKNOWN_QUEUE <queue>
+    else if (cmd == "EXTRACT_FROM") {
+        std::string department;
+        in >> department;
+
+        int d = queue->findDepartment(department);
+        TriageEntry n;
+        if (d < 0) {
+            out << "ERROR_UNKNOWN_QUEUE " << department << "\n";
+        } else if (treatNext(n, d, "EXTRACT_FROM")) {
+            writeDepartmentData(out, n, queue->departmentName(d));
+        } else {
+            out << "EMPTY\n";
+        }
+    }
+
+    // --- EXTRACT_ANY (Treat the Most Urgent Patient of Any Department) ---
+    // Picks among the department heads by (ESI, arrival): O(#departments).
+    // Output: DATA [ID] [PRIO] [AGE] [NAME] [DESC] [QUEUE they waited in] | EMPTY
+    else if (cmd == "EXTRACT_ANY") {
+        TriageEntry n;
+        int d = ANY_DEPARTMENT;
+        if (treatNext(n, d, "EXTRACT_ANY")) {
+            writeDepartmentData(out, n, queue->departmentName(d));
+        } else {
+            out << "EMPTY\n";
+        }
+    }
+
+    // --- TRANSFER (Move a Waiting Patient to Another Department) ---
+    // Usage: TRANSFER <id> <queue>. The patient keeps their ID, record, arrival
+    // and wait clock: the engine moves the node itself, no LEAVE + ADD.
+    // Output: SUCCESS_TRANSFER <id> <queue> | ERROR_UNKNOWN_QUEUE <queue> | ERROR_NOT_QUEUED <id>
+    else if (cmd == "TRANSFER") {
+        long long id;
+        std::string department;
+        if (!(in >> id)) {
+            skipBadLine(in);
+            out << "ERROR: Invalid patient ID\n";
+            return;
+        }
+        in >> department;
+
+        int d = queue->findDepartment(department);
+        if (d < 0) {
+            out << "ERROR_UNKNOWN_QUEUE " << department << "\n";
+        } else if (!transferPatient(id, d)) {
+            out << "ERROR_NOT_QUEUED " << id << "\n";
         } else {
-            std::cout << "EMPTY" << std::endl;
+            out << "SUCCESS_TRANSFER " << id << " " << department << "\n";
         }
     }
 
+    // --- TOPK (Next K Patients, Read-Only) ---
+    // Output: TOP_DATA [ID] [PRIO] [AGE] [NAME] [DESC] lines in EXTRACT order, then TOPK_END <n>
+    else if (cmd == "TOPK") {
+        int k = 0;
+        in >> k;
+        if (k <= 0) {
+            out << "ERROR: K must be positive\n";
+            return;
+        }
+
+        int n = queue->forEachTopK(k, [&out](const TriageEntry& e) {
+            out << "TOP_DATA " << e.id << " "
+                << e.priority << " "
+                << e.record->age << " "
+                << textField(e.record->name) << " "
+                << textField(e.record->description) << "\n";
+        });
+        out << "TOPK_END " << n << "\n";
+    }
+
+    // --- RANGE (Every Patient in a Priority Band, Read-Only) ---
+    // Usage: RANGE 1 2 -> the critical board. Same lines as TOPK, then RANGE_END <n>
+    else if (cmd == "RANGE") {
+        int lo = 0, hi = 0;
+        in >> lo >> hi;
+        if (lo < MIN_PRIORITY || hi > MAX_PRIORITY || lo > hi) {
+            out << "ERROR: Range must be within 1-10\n";
+            return;
+        }
+
+        int n = queue->forEachInRange(lo, hi, [&out](const TriageEntry& e) {
+            out << "TOP_DATA " << e.id << " "
+                << e.priority << " "
+                << e.record->age << " "
+                << textField(e.record->name) << " "
+                << textField(e.record->description) << "\n";
+        });
+        out << "RANGE_END " << n << "\n";
+    }
+
     // --- STATS (Dashboard Data) ---
+    // Output: STATS COUNT:<n> WAIT:<median mins> TREATED:<n> ESI<k>:<p50>/<p90>/<p99> ...
+    // Waits are observed times-to-treatment (-1 = nobody treated yet); only
+    // levels with at least one treatment are listed. Outside batches the
+    // reader thread answers this from the published view (see Pipeline.h).
     else if (cmd == "STATS") {
-        int count = heap.getNumNodes();
-        // Estimation: 15 mins per patient
-        int waitTime = count * 15; 
-        std::cout << "STATS COUNT:" << count << " WAIT:" << waitTime << std::endl;
+        publishStats();
+        writeStats(out, stats);
+    }
+
+    // --- POOL (Node Allocator Statistics) ---
+    else if (cmd == "POOL") {
+        PoolStats pool = queue->getPoolStats();
+        out << "POOL LIVE:" << pool.live
+                  << " PEAK:" << pool.highWater
+                  << " CAPACITY:" << pool.capacity
+                  << " SLABS:" << pool.slabs << "\n";
+    }
+
+    // --- METRICS (Backend Instrumentation, Prometheus Text Format) ---
+    // Output: command latency histograms, queue gauges and (fib engines) heap
+    // shape, then "# EOF". Built with TRIAGE_METRICS=0 only the gauges remain.
+    else if (cmd == "METRICS") {
+        metrics.write(out);
+
+        PoolStats pool = queue->getPoolStats();
+        writeMetric(out, "triage_patients_waiting", "gauge", "Patients in the queue", queue->getNumNodes());
+        writeMetric(out, "triage_patients_treated_total", "counter", "Patients handed out by EXTRACT",
+                    waits.totalTreated());
+        writeMetric(out, "triage_pool_live_nodes", "gauge", "Queue nodes in use", pool.live);
+        writeMetric(out, "triage_pool_capacity_nodes", "gauge", "Queue node slots allocated", pool.capacity);
+        writeMetric(out, "triage_audit_images", "gauge", "Queue images kept for AUDIT", audit.imagesKept());
+        writeMetric(out, "triage_departments", "gauge", "Department queues (main included)",
+                    queue->departmentCount());
+
+        HeapShape shape;
+        if (queue->getHeapShape(shape)) writeHeapShape(out, shape);
+        out << "# EOF\n";
     }
 
     // --- LIST (Dump All Patients for GUI Sync) ---
     else if (cmd == "LIST") {
-        heap.printAll();
+        queue->printAll(out);
+    }
+
+    // --- SUBSCRIBE (Baseline for Incremental Sync) ---
+    // Sends the full queue once, then the version to pass to CHANGES.
+    else if (cmd == "SUBSCRIBE") {
+        queue->printAll(out);
+        out << "SUBSCRIBED " << feed.getVersion() << "\n";
+    }
+
+    // --- SNAPSHOT (Whole Dashboard State in One Reply) ---
+    // Output: SNAPSHOT <version> <count>, the STATS line, <count> LIST_DATA lines
+    // (EXTRACT order), then SNAPSHOT_END <version>. Like SUBSCRIBE, CHANGES can
+    // continue from <version>, so a dashboard needs a single round-trip to resync.
+    else if (cmd == "SNAPSHOT") {
+        publishStats();
+        long long version = feed.getVersion();
+        out << "SNAPSHOT " << version << " " << queue->getNumNodes() << "\n";
+        writeStats(out, stats);
+        queue->printAll(out);
+        out << "SNAPSHOT_END " << version << "\n";
+    }
+
+    // --- CHANGES (Delta Since Last Seen Version) ---
+    // Output: CHANGE <ver> ADD|UPDATE|REMOVE ... lines, then CHANGES_END <ver>
+    else if (cmd == "CHANGES") {
+        long long since;
+        in >> since;
+        feed.writeSince(since, out);
     }
 
     // --- UPDATE PRIORITY (Dynamic Deterioration) ---
     // Usage: When a patient's condition worsens.
     else if (cmd == "UPDATE") {
-        int id, newPrio;
-        std::cin >> id >> newPrio;
+        long long id;
+        int newPrio;
+        if (!(in >> id)) {
+            skipBadLine(in);
+            out << "ERROR: Invalid patient ID\n";
+            return;
+        }
+        if (!(in >> newPrio)) {
+            skipBadLine(in);
+            out << "ERROR: Priority must be 1-10\n";
+            return;
+        }
+
+        if (newPrio < MIN_PRIORITY || newPrio > MAX_PRIORITY) {
+            out << "ERROR: Priority must be 1-10\n";
+            return;
+        }
         
-        // This calls our safety wrapper in FibHeap.cpp which checks the array bounds
-        heap.updatePriority(id, newPrio); 
-        std::cout << "SUCCESS_UPDATE" << std::endl;
+        // The queue checks that the ID exists
+        if (!retriage(id, newPrio)) {
+            out << "Error: Patient ID " << id << " not found.\n";
+        } else {
+            out << "SUCCESS_UPDATE\n";
+        }
     }
 
     // --- LEAVE (LWBS - Left Without Being Seen) ---
     // Usage: When a patient walks out.
     else if (cmd == "LEAVE") {
-        int id;
-        std::cin >> id;
-        heap.removePatient(id);
-        std::cout << "SUCCESS_REMOVE " << id << std::endl;
+        long long id;
+        if (!(in >> id)) {
+            skipBadLine(in);
+            out << "ERROR: Invalid patient ID\n";
+            return;
+        }
+        leavePatient(id);
+        out << "SUCCESS_REMOVE " << id << "\n";
+    }
+
+    // --- LEAVE_MANY (Several Walkouts at Once) ---
+    // Usage: LEAVE_MANY <n> <id 1> ... <id n>
+    // Output: SUCCESS_REMOVE <id> per patient found, then SUCCESS_REMOVE_MANY <removed>
+    // <n> is at most MAX_LEAVE_MANY; a list with fewer than <n> valid IDs removes nobody.
+    else if (cmd == "LEAVE_MANY") {
+        int count;
+        in >> count;
+        if (!in || count < 0 || count > MAX_LEAVE_MANY) {
+            skipBadLine(in);
+            out << "ERROR: Invalid patient count (0-" << MAX_LEAVE_MANY << ")\n";
+            return;
+        }
+
+        long long* ids = new long long[count];
+        int read = 0;
+        while (read < count && in >> ids[read]) read++;
+        if (read < count) {
+            // The word that is not an ID stays unread: it may be the next command
+            in.clear();
+            out << "ERROR: Expected " << count << " patient IDs, got " << read << "\n";
+            delete[] ids;
+            return;
+        }
+        bool* removed = new bool[count];
+
+        // Copy the records before they go. They are journaled only once we
+        // know someone left: record() forgets the redo history (and with a
+        // full ring the oldest undo step), which a no-op must not cost.
+        PatientRow* rows = new PatientRow[count];
+        int* departments = new int[count];
+        for (int i = 0; i < count; i++) {
+            TriageEntry e;
+            if (queue->find(ids[i], e)) keepPatient(rows[i], e);
+            departments[i] = queue->departmentOf(ids[i]);
+        }
+
+        int removedCount = queue->removePatients(ids, count, removed);
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            if (!removed[i]) continue;
+            wal.logLeave(ids[i]);
+            feed.recordRemove(ids[i]);
+            aging.cancel(ids[i]);
+            audit.erase(ids[i]);
+            if (kept != i) {
+                std::swap(rows[kept], rows[i]);
+                departments[kept] = departments[i];
+            }
+            kept++;
+            out << "SUCCESS_REMOVE " << ids[i] << "\n";
+        }
+
+        // One UNDO step for the whole list
+        if (kept > 0) {
+            UndoStep& step = journal.record(UNDO_REMOVED, "LEAVE_MANY", kept);
+            for (int i = 0; i < kept; i++) {
+                std::swap(step.patients[i], rows[i]);
+                step.departments[i] = departments[i];
+            }
+        }
+        out << "SUCCESS_REMOVE_MANY " << removedCount << "\n";
+
+        delete[] ids;
+        delete[] removed;
+        delete[] rows;
+        delete[] departments;
     }
 
     // --- MERGE (Mass Casualty Event) ---
-    // Usage: Merges an external list (e.g., from an ambulance) into the main heap instantly.
+    // Usage: Merges an external list (e.g., from an ambulance) into the main queue instantly.
     else if (cmd == "MERGE") {
         std::string filename;
-        std::cin >> filename;
+        in >> filename;
         
-        FibonacciHeap tempHeap;
-        std::ifstream file(filename);
+        // Accepts both the text format and binary snapshots
+        TriageQueue* tempQueue = queue->createEmpty();
+        long long maxId = 0;
         
-        if (file.is_open()) {
-            int id, prio, age;
-            std::string name, desc;
-            while (file >> id >> prio >> age >> name >> desc) {
-                // In a real system, we would re-map IDs to avoid collisions.
-                // For this project, we assume the file contains unique IDs.
-                tempHeap.insert(id, prio, age, name, desc);
+        if (loadPatientFile(filename, *tempQueue, maxId)) {
+            // Log and announce the incoming patients; taken back if the merge is refused
+            size_t walMark = wal.getMark();
+            wal.logMerge(*tempQueue);
+            long long mark = feed.getVersion();
+
+            // Remember who arrives: their wait clocks start only if the merge succeeds
+            int incoming = tempQueue->getNumNodes();
+            TriageEntry* arrivals = new TriageEntry[incoming];
+            int n = 0;
+            tempQueue->forEachPatient([&](const TriageEntry& e) {
+                feed.recordAdd(e.id, e.priority, e.record->age, e.record->name, e.record->description);
+                arrivals[n++] = e;
+            });
+
+            // Perform the O(1) merge operation (refused if an ID is already queued)
+            long long collidingId;
+            if (queue->merge(*tempQueue, collidingId)) {
+                // UNDO takes the whole file back out
+                UndoStep& step = journal.record(UNDO_ADDED, "MERGE", n);
+                for (int i = 0; i < n; i++) {
+                    aging.arm(arrivals[i].id, arrivals[i].priority, arrivals[i].arrival);
+                    step.patients[i].id = arrivals[i].id;
+
+                    TriageEntry e;
+                    if (queue->find(arrivals[i].id, e)) {
+                        audit.put(e.id, e.priority, e.record->age, e.arrival, e.record->name, e.record->description);
+                    }
+                }
+                // Keep auto-generated IDs clear of the merged ones
+                if (maxId >= nextId) nextId = maxId + 1;
+                out << "SUCCESS_MERGE\n";
+            } else {
+                wal.rollback(walMark);
+                feed.rollback(mark);
+                out << "ERROR_MERGE_COLLISION " << collidingId << "\n";
             }
-            file.close();
-            
-            // Perform the O(1) merge operation
-            heap.merge(tempHeap);
-            std::cout << "SUCCESS_MERGE" << std::endl;
+            delete[] arrivals;
+        } else {
+            out << "ERROR_FILE_NOT_FOUND\n";
+        }
+        delete tempQueue;
+    }
+
+    // --- UNDO / REDO (Take Back the Last Mutating Command) ---
+    // Covers ADD, EXTRACT, UPDATE, LEAVE, LEAVE_MANY, MERGE and the department
+    // commands (ADD_TO, EXTRACT_FROM, EXTRACT_ANY, TRANSFER), newest first, up to
+    // the last 64. Patients come back with their ID, department and place in line.
+    // Output: SUCCESS_UNDO|SUCCESS_REDO <command> <patients>, ERROR_NOTHING_TO_UNDO|REDO,
+    // or ERROR_UNDO_CONFLICT <id> when the queue has moved on (e.g. that ID was re-used by a MERGE)
+    else if (cmd == "UNDO" || cmd == "REDO") {
+        bool undo = (cmd == "UNDO");
+        UndoStep* step = undo ? journal.nextUndo() : journal.nextRedo();
+        long long conflictId;
+        if (step == nullptr) {
+            out << (undo ? "ERROR_NOTHING_TO_UNDO\n" : "ERROR_NOTHING_TO_REDO\n");
+        } else if (!invertStep(*step, conflictId)) {
+            out << "ERROR_UNDO_CONFLICT " << conflictId << "\n";
+        } else {
+            if (undo) journal.undone();
+            else journal.redone();
+            out << (undo ? "SUCCESS_UNDO " : "SUCCESS_REDO ") << step->command << " " << step->count << "\n";
+        }
+    }
+
+    // --- AUDIT (Queue State at a Past Time, Read-Only) ---
+    // Usage: AUDIT 02:00 or AUDIT <unix seconds>. Answered from the audit images
+    // (taken at most once a minute), never from the live queue; outside batches
+    // the reader thread answers it (see Pipeline.h).
+    // Output: AUDIT <taken at> <n>, AUDIT_DATA lines like TOP_DATA, then AUDIT_END <n>
+    else if (cmd == "AUDIT") {
+        std::string when;
+        in >> when;
+        audit.query(when, out);
+    }
+
+    // --- EXPORT (Text Copy of the Queue) ---
+    // Writes the legacy "[ID] [PRIORITY] [AGE] [NAME] [DESC]" format.
+    else if (cmd == "EXPORT") {
+        std::string filename;
+        in >> filename;
+        if (queue->saveToFile(filename)) {
+            out << "SUCCESS_EXPORT\n";
         } else {
-            std::cout << "ERROR_FILE_NOT_FOUND" << std::endl;
+            out << "ERROR_FILE_NOT_FOUND\n";
         }
     }
 
     else {
-        std::cout << "ERROR_UNKNOWN_COMMAND" << std::endl;
+        out << "ERROR_UNKNOWN_COMMAND\n";
         // Clear the line to prevent infinite loops if garbage is sent
-        std::string garbage; std::getline(std::cin, garbage);
+        std::string garbage; std::getline(in, garbage);
     }
 }
\ No newline at end of file
@@ -1,23 +1,124 @@
 #ifndef SYSTEM_H
 #define SYSTEM_H
 
-#include "FibHeap.h"
+#include "TriageQueue.h"
+#include "DepartmentQueue.h"
 #include "Auth.h"
+#include "ChangeFeed.h"
+#include "Snapshot.h"
+#include "WriteAheadLog.h"
+#include "AgingWheel.h"
+#include "WaitStats.h"
+#include "Pipeline.h"
+#include "Server.h"
+#include "Metrics.h"
+#include "UndoJournal.h"
+#include "AuditTrail.h"
 #include <string>
+#include <iostream>
+
+// Persistence files (binary snapshot is preferred, text is the legacy format)
+const std::string SNAPSHOT_FILE = "patients_data.bin";
+const std::string TEXT_FILE = "patients_data.txt";
+const std::string WAL_FILE = "patients_data.wal";
+const std::string DEPARTMENTS_FILE = "patients_data.departments"; // Who waits outside "main"
+
+// treatNext(): take the most urgent patient of whichever department (EXTRACT_ANY)
+const int ANY_DEPARTMENT = -1;
+
+// Most IDs one LEAVE_MANY may list (the ID list and its UNDO step are sized by it)
+const int MAX_LEAVE_MANY = 100000;
 
 // ASSIGNED TO: MEMBER 5
-class System {
+class System : private SessionHandler {
 private:
-    FibonacciHeap heap;
+    DepartmentQueue* queue; // One queue per department, all of the engine picked at startup
     AuthSystem auth;
-    bool isLoggedIn;
-    int nextId;
+    ChangeFeed feed;    // Versioned queue changes for SUBSCRIBE / CHANGES
+    WriteAheadLog wal;  // Every mutation since the last snapshot
+    AgingWheel aging;   // Max-wait deadlines of the waiting patients
+    WaitStats waits;    // Observed time-to-treatment per ESI level
+    CommandMetrics metrics; // Per-command latency (METRICS)
+    UndoJournal journal;    // The last mutating commands, for UNDO / REDO
+    AuditTrail audit;       // Copy-on-write images of the queue for AUDIT
+    bool consoleLoggedIn;   // Login state of the stdin/stdout client
+    bool* isLoggedIn;       // Login state of the client being served right now
+    Pipeline* pipeline; // Threads and rings of run(); nullptr before that
+    bool serving;       // serve() is running: EXIT ends a session, not the backend
+    StatsView stats;    // Last STATS view (percentiles recomputed only after a treatment)
+    long long statsRevision; // WaitStats revision 'stats' was computed from
+    long long nextId;   // 64-bit so long-running instances never run out
+
+    // Non-copyable: owns the queue
+    System(const System&);
+    System& operator=(const System&);
+
+    // Writes this command's log records; folds the log into the snapshot when it grows
+    bool commitLog();
+
+    // Escalates every patient whose max wait for their level ran out
+    void runAging();
+
+    // Refreshes 'stats' and hands it (and the login state) to the reader thread
+    void publishStats();
+
+    // Saves a full snapshot and empties the log (compaction)
+    bool checkpoint();
 
-    void processCommand(std::string cmd);
+    // Runs one command. Arguments are read from 'in', the reply goes to 'out'.
+    // Returns false when the backend should stop (EXIT).
+    bool execute(const std::string& command, std::istream& in, std::ostream& out);
+    bool dispatch(const std::string& command, std::istream& in, std::ostream& out); // execute() minus timing
+    void processCommand(const std::string& cmd, std::istream& in, std::ostream& out);
+
+    // Reads a text or binary patient file into 'target' (format is auto-detected)
+    bool loadPatientFile(const std::string& filename, TriageQueue& target, long long& maxId);
+
+    // Runs a BEGIN ... END / BATCH <n> block with a single buffered write
+    bool runBatch(const std::string& frame, std::istream& in, std::ostream& out);
+
+    // Command cores shared by the text and binary protocols: each one updates
+    // the queue, the log, the change feed, the wait clocks and the statistics.
+    // 'command' names the UNDO step. treatNext() serves 'department' (or the
+    // most urgent head, ANY_DEPARTMENT) and sets it to where the patient waited.
+    long long admitPatient(int priority, int age, const std::string& name, const std::string& desc,
+                           int department = 0, const char* command = "ADD");
+    bool treatNext(TriageEntry& out, int& department, const char* command = "EXTRACT"); // false = nobody waiting
+    bool retriage(long long id, int priority);
+    bool leavePatient(long long id);
+    bool transferPatient(long long id, int department); // false = not queued
+
+    // UNDO / REDO: applies the opposite of 'step' (through the same log, feed,
+    // wait clock and audit updates) and turns the step into that opposite.
+    // Changes nothing and returns false if the queue no longer matches the
+    // step; 'conflictId' is the patient in the way.
+    bool invertStep(UndoStep& step, long long& conflictId);
+
+    // Runs text commands (lines and blocks) until the input ends or EXIT
+    bool runText(std::istream& in, std::ostream& out);
+
+    // SessionHandler (server mode, and onIdle() for the console's input wait):
+    // one client's commands, with its own login
+    bool handleCommands(const std::string& unit, bool& loggedIn, std::string& reply);
+    bool handleFrame(const char* frame, size_t length, bool& loggedIn, std::string& reply);
+    void onIdle();
 
 public:
-    System();
-    void run(); // The main loop
+    // 'engine' selects the queue implementation: "fib" (default), "fib-age" or "bucket".
+    // 'agingScale' speeds up the wait clock (1 = real time; for demos and tests).
+    // 'authCost' is the KDF iteration count for stored passwords (see Auth.h).
+    // 'queues' lists department queues to run next to "main", comma-separated
+    // (e.g. "trauma,peds,fast-track"; see DepartmentQueue).
+    System(const std::string& engine = "fib", int agingScale = 1, int authCost = DEFAULT_KDF_ITERATIONS,
+           const std::string& queues = "");
+    ~System();
+    // The main loop: a reader thread splits stdin into commands, this thread
+    // (the only one touching the queue) runs them, a writer thread sends replies
+    void run();
+
+    // Server mode: serves many socket clients instead of stdin/stdout (see Server.h
+    // for the address forms) until SIGINT/SIGTERM. false if it cannot listen.
+    bool serve(const std::string& address);
 };
 
 #endif
\ No newline at end of file
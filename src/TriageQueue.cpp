@@ -0,0 +1,14 @@
+#include "TriageQueue.h"
+#include "FibonacciQueue.h"
+#include "BucketQueue.h"
+
+// ==========================================
+// QUEUE ENGINE FACTORY
+// ==========================================
+
+TriageQueue* TriageQueue::create(const std::string& engine) {
+    if (engine == "fib") return new FibonacciQueue<EsiArrivalKey>();
+    if (engine == "fib-age") return new FibonacciQueue<EsiAgeArrivalKey>();
+    if (engine == "bucket") return new BucketQueue();
+    return nullptr;
+}
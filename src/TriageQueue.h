@@ -0,0 +1,138 @@
+#ifndef TRIAGEQUEUE_H
+#define TRIAGEQUEUE_H
+
+#include <string>
+#include <ostream>
+#include "Patient.h"
+#include "NodePool.h"
+#include "PriorityKey.h"
+#include "Metrics.h"
+
+// Lowest and highest priority accepted by ADD / UPDATE (ESI 1 = Critical)
+const int MIN_PRIORITY = 1;
+const int MAX_PRIORITY = 10;
+
+// Longest name or description accepted (binary replies carry 16-bit lengths)
+const int MAX_TEXT_LENGTH = 65535;
+
+// What the command layer sees of a queued patient
+struct TriageEntry {
+    long long id;
+    int priority;
+    long long arrival;      // Microseconds since the epoch (FIFO tiebreak)
+    PatientRecord* record;  // Cold data (age, name, description)
+};
+
+// Callback for TriageQueue::visitPatients()
+class PatientVisitor {
+public:
+    virtual ~PatientVisitor() {}
+    virtual void visit(const TriageEntry& entry) = 0;
+};
+
+// Adapts any callable (e.g. a lambda) to PatientVisitor
+template <typename Fn>
+class LambdaVisitor : public PatientVisitor {
+private:
+    Fn fn;
+public:
+    LambdaVisitor(Fn f) : fn(f) {}
+    void visit(const TriageEntry& entry) { fn(entry); }
+};
+
+// Common interface of the queue engines used by System.
+//   "fib"     -> FibonacciQueue<EsiArrivalKey>    (ESI, then arrival time)
+//   "fib-age" -> FibonacciQueue<EsiAgeArrivalKey> (ESI, then age risk, then arrival)
+//   "bucket"  -> BucketQueue (ten FIFO buckets, O(1) everything, 1-10 only)
+class TriageQueue {
+public:
+    virtual ~TriageQueue() {}
+
+    // false = duplicate ID or priority the engine can't hold.
+    // 'arrival' is only passed when restoring saved patients.
+    virtual bool insert(long long id, int priority, int age, std::string name, std::string desc,
+                        long long arrival = ARRIVAL_NOW) = 0;
+
+    // Fills 'out' with the most urgent patient; false if the queue is empty
+    virtual bool peek(TriageEntry& out) = 0;
+
+    // Removes the most urgent patient. out.record stays valid until the next extractMin().
+    virtual bool extractMin(TriageEntry& out) = 0;
+
+    virtual PatientRecord* getRecord(long long id) = 0;
+
+    // Fills 'out' with a queued patient; false if the ID is not in the queue
+    // (the patient just handed out by extractMin() no longer is)
+    virtual bool find(long long id, TriageEntry& out) = 0;
+
+    virtual bool updatePriority(long long id, int newPriority) = 0; // false = unknown ID / bad priority
+    virtual bool removePatient(long long id) = 0;                   // false = unknown ID
+    virtual int removePatients(const long long* ids, int count, bool* removedFlags) = 0;
+
+    // Bulk load (snapshots, manifests): same result as insert() row by row -
+    // bad priorities are skipped and a repeated ID keeps its first row - but
+    // the heap engines build their forest in one pass. The rows' strings are
+    // moved out. Returns the number of patients added.
+    virtual int insertMany(PatientRow* rows, int count) = 0;
+
+    // Moves every patient of 'other' (same engine, see createEmpty()) into this queue.
+    // Returns false (and changes nothing) on a duplicate ID, reported in 'collidingId'.
+    virtual bool merge(TriageQueue& other, long long& collidingId) = 0;
+
+    // Moves a queued patient into 'target' (same engine, see createEmpty()) as
+    // they are: same ID, record and arrival, nothing copied or allocated.
+    // Their memory stays with this queue, so queues that traded patients must
+    // give all their storage to one survivor with adoptStorage() before any
+    // of them is destroyed (DepartmentQueue does this).
+    // false = unknown ID, already in 'target', or 'target' is another engine.
+    virtual bool transfer(long long id, TriageQueue& target) = 0;
+
+    // Teardown of queues that traded patients: this queue takes over all of
+    // other's memory. After that 'other' may only be destroyed.
+    virtual void adoptStorage(TriageQueue& other) = 0;
+
+    virtual void reserve(int n) = 0;
+    virtual int getNumNodes() = 0;
+    virtual PoolStats getPoolStats() = 0;
+    virtual bool getHeapShape(HeapShape& out) = 0;      // false = not a heap engine (bucket)
+    virtual bool saveToFile(std::string filename) = 0;  // Text export
+    virtual void printAll(std::ostream& out) = 0;       // LIST_DATA lines
+
+    // Calls visitor.visit() once per queued patient (order is engine-specific)
+    virtual void visitPatients(PatientVisitor& visitor) = 0;
+
+    // Read-only ordered queries (the queue is not modified), most urgent first.
+    // visitTopK: the next 'k' patients EXTRACT would hand out.
+    // visitRange: every patient with lo <= priority <= hi.
+    // Both return the number of patients visited.
+    virtual int visitTopK(int k, PatientVisitor& visitor) = 0;
+    virtual int visitRange(int lo, int hi, PatientVisitor& visitor) = 0;
+
+    // A new, empty queue of the same engine (MERGE and snapshot loading use it)
+    virtual TriageQueue* createEmpty() = 0;
+    virtual const char* engineName() = 0;
+
+    // Convenience wrapper: queue.forEachPatient([](const TriageEntry& e) { ... });
+    template <typename Fn>
+    void forEachPatient(Fn fn) {
+        LambdaVisitor<Fn> visitor(fn);
+        visitPatients(visitor);
+    }
+
+    template <typename Fn>
+    int forEachTopK(int k, Fn fn) {
+        LambdaVisitor<Fn> visitor(fn);
+        return visitTopK(k, visitor);
+    }
+
+    template <typename Fn>
+    int forEachInRange(int lo, int hi, Fn fn) {
+        LambdaVisitor<Fn> visitor(fn);
+        return visitRange(lo, hi, visitor);
+    }
+
+    // Engine factory. Returns nullptr for an unknown engine name.
+    static TriageQueue* create(const std::string& engine);
+};
+
+#endif
@@ -0,0 +1,61 @@
+#include "UndoJournal.h"
+
+// ==========================================
+// UNDO JOURNAL IMPLEMENTATION
+// ==========================================
+
+UndoJournal::UndoJournal() {
+    steps = new UndoStep[DEPTH];
+    for (int i = 0; i < DEPTH; i++) {
+        steps[i].patients = nullptr;
+        steps[i].departments = nullptr;
+        steps[i].count = 0;
+        steps[i].capacity = 0;
+    }
+    first = 0;
+    undoable = 0;
+    redoable = 0;
+}
+
+UndoJournal::~UndoJournal() {
+    for (int i = 0; i < DEPTH; i++) {
+        delete[] steps[i].patients;
+        delete[] steps[i].departments;
+    }
+    delete[] steps;
+}
+
+UndoStep& UndoJournal::record(UndoKind kind, const char* command, int patients) {
+    // 1. A new command ends the redo history
+    redoable = 0;
+
+    // 2. Full ring: the oldest step falls off
+    if (undoable == DEPTH) {
+        first = (first + 1) % DEPTH;
+        undoable--;
+    }
+
+    UndoStep& step = at(undoable);
+    undoable++;
+
+    // 3. Reuse the slot's rows when they are big enough (the usual single patient)
+    if (step.capacity < patients) {
+        delete[] step.patients;
+        delete[] step.departments;
+        step.patients = new PatientRow[patients];
+        step.departments = new int[patients];
+        step.capacity = patients;
+    }
+    for (int i = 0; i < patients; i++) step.departments[i] = 0;
+
+    step.kind = kind;
+    step.command = command;
+    step.treated = false;
+    step.waitMinutes = 0;
+    step.fromPriority = 0;
+    step.toPriority = 0;
+    step.fromDepartment = 0;
+    step.toDepartment = 0;
+    step.count = patients;
+    return step;
+}
@@ -0,0 +1,75 @@
+#ifndef UNDOJOURNAL_H
+#define UNDOJOURNAL_H
+
+#include "Patient.h"
+
+// What a journaled command did to the queue. Undoing a step applies the
+// opposite and turns the step into that opposite, so REDO is just the
+// same inversion run again.
+enum UndoKind {
+    UNDO_ADDED,     // Patients entered the queue (ADD, MERGE; undo = take them out)
+    UNDO_REMOVED,   // Patients left the queue (EXTRACT, LEAVE; undo = put them back)
+    UNDO_UPDATED,   // One patient's priority changed (UPDATE; undo = set it back)
+    UNDO_MOVED      // One patient changed department (TRANSFER; undo = move them back)
+};
+
+// One journaled command. 'patients' is only complete for UNDO_REMOVED
+// (everything needed to put them back, original arrival included);
+// UNDO_ADDED steps only need the IDs, the rest is read when they are undone.
+struct UndoStep {
+    UndoKind kind;
+    const char* command;    // Command that made the step, for the UNDO / REDO reply
+    bool treated;           // EXTRACT: the wait statistics counted these patients
+    int waitMinutes;        // ... in this histogram bucket (see WaitStats)
+    int fromPriority;       // UNDO_UPDATED: before ...
+    int toPriority;         // ... and after
+    int fromDepartment;     // UNDO_MOVED: before ...
+    int toDepartment;       // ... and after
+
+    PatientRow* patients;   // Kept when the slot is reused (strings keep their buffers)
+    int* departments;       // UNDO_REMOVED: the department each patient was queued in
+    int count;
+    int capacity;
+};
+
+// Bounded undo/redo history of the mutating commands.
+//
+// The last DEPTH steps sit in a ring, oldest first: the first 'undoable'
+// can be undone, the 'redoable' after them were undone and can be redone.
+// UNDO and REDO only move the cursor between the two groups, so neither
+// copies a step; a new command drops the redo group and takes the next
+// slot, overwriting the oldest step once the ring is full. Slots keep
+// their patient arrays, so a steady stream of commands allocates nothing.
+class UndoJournal {
+private:
+    static const int DEPTH = 64;
+
+    UndoStep* steps;
+    int first;      // Ring position of the oldest step
+    int undoable;
+    int redoable;
+
+    // Non-copyable: owns the ring
+    UndoJournal(const UndoJournal&);
+    UndoJournal& operator=(const UndoJournal&);
+
+    UndoStep& at(int offset) { return steps[(first + offset) % DEPTH]; }
+
+public:
+    UndoJournal();
+    ~UndoJournal();
+
+    // Starts a new step with room for 'patients' rows (its 'count') and
+    // forgets everything that could have been redone. Fill it in right away.
+    UndoStep& record(UndoKind kind, const char* command, int patients);
+
+    // The step UNDO / REDO would invert next; nullptr = nothing to do
+    UndoStep* nextUndo() { return (undoable > 0) ? &at(undoable - 1) : nullptr; }
+    UndoStep* nextRedo() { return (redoable > 0) ? &at(undoable) : nullptr; }
+
+    // Moves the cursor once that step was inverted
+    void undone() { undoable--; redoable++; }
+    void redone() { undoable++; redoable--; }
+};
+
+#endif
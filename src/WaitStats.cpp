@@ -0,0 +1,79 @@
+#include "WaitStats.h"
+#include <chrono>
+
+// ==========================================
+// WAIT STATISTICS IMPLEMENTATION
+// ==========================================
+
+WaitStats::WaitStats() {
+    int rows = MAX_PRIORITY + 1;
+    histogram = new int[rows * BUCKETS];
+    treated = new long long[rows];
+    for (int i = 0; i < rows * BUCKETS; i++) histogram[i] = 0;
+    for (int i = 0; i < rows; i++) treated[i] = 0;
+    revision = 0;
+}
+
+WaitStats::~WaitStats() {
+    delete[] histogram;
+    delete[] treated;
+}
+
+int WaitStats::recordTreatment(int priority, long long arrivalMicros) {
+    if (priority < MIN_PRIORITY || priority > MAX_PRIORITY) return 0;
+
+    long long now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // 1. Wait in whole minutes, clamped into the histogram
+    long long minutes = (now - arrivalMicros) / 60000000LL;
+    if (minutes < 0) minutes = 0; // Wall clock stepped back
+    if (minutes >= BUCKETS) minutes = BUCKETS - 1;
+
+    // 2. One counter for the level, one for the aggregate row
+    histogram[priority * BUCKETS + minutes]++;
+    histogram[minutes]++;
+    treated[priority]++;
+    treated[0]++;
+    revision++;
+    return (int)minutes;
+}
+
+void WaitStats::forgetTreatment(int priority, int minutes) {
+    if (priority < MIN_PRIORITY || priority > MAX_PRIORITY) return;
+    if (minutes < 0 || minutes >= BUCKETS) return;
+    if (histogram[priority * BUCKETS + minutes] == 0) return; // Never recorded
+
+    histogram[priority * BUCKETS + minutes]--;
+    histogram[minutes]--;
+    treated[priority]--;
+    treated[0]--;
+    revision++;
+}
+
+int WaitStats::percentile(int row, int percent) {
+    if (treated[row] == 0) return -1;
+
+    // Rank of the wanted sample (1-based, rounded up)
+    long long rank = (treated[row] * percent + 99) / 100;
+    if (rank < 1) rank = 1;
+
+    const int* counts = histogram + row * BUCKETS;
+    long long seen = 0;
+    for (int m = 0; m < BUCKETS; m++) {
+        seen += counts[m];
+        if (seen >= rank) return m;
+    }
+    return BUCKETS - 1;
+}
+
+WaitSummary WaitStats::summary(int priority) {
+    WaitSummary s;
+    if (priority < 0 || priority > MAX_PRIORITY) priority = 0;
+
+    s.treated = treated[priority];
+    s.p50 = percentile(priority, 50);
+    s.p90 = percentile(priority, 90);
+    s.p99 = percentile(priority, 99);
+    return s;
+}
@@ -0,0 +1,55 @@
+#ifndef WAITSTATS_H
+#define WAITSTATS_H
+
+#include "TriageQueue.h"
+
+// Summary of the observed waits at one ESI level (minutes; -1 = no data yet)
+struct WaitSummary {
+    long long treated;  // Patients treated at this level so far
+    int p50;
+    int p90;
+    int p99;
+};
+
+// Streaming time-to-treatment statistics per ESI level.
+//
+// Each level keeps a fixed-size histogram with one-minute buckets, so
+// recording a treatment is O(1) and a percentile query only walks the
+// buckets of that level - never the queue. Row 0 aggregates all levels.
+class WaitStats {
+private:
+    static const int BUCKETS = 721;     // 0..719 min, last bucket = 12 h or more
+
+    int* histogram;                     // (MAX_PRIORITY + 1) rows of BUCKETS counters
+    long long* treated;                 // Per row: number of recorded waits
+    long long revision;                 // Bumped by every record / forget
+
+    // Non-copyable: owns the histograms
+    WaitStats(const WaitStats&);
+    WaitStats& operator=(const WaitStats&);
+
+    // Smallest wait (minutes) with at least 'percent' of the row at or below it
+    int percentile(int row, int percent);
+
+public:
+    WaitStats();
+    ~WaitStats();
+
+    // A patient at 'priority' was treated after waiting since 'arrivalMicros'.
+    // Returns the wait in minutes as counted (the bucket forgetTreatment() needs).
+    int recordTreatment(int priority, long long arrivalMicros);
+
+    // Takes back a treatment recorded with that wait (the EXTRACT was undone)
+    void forgetTreatment(int priority, int minutes);
+
+    // Level 0 = all levels together
+    WaitSummary summary(int priority);
+
+    // Treatments recorded so far
+    long long totalTreated() { return treated[0]; }
+
+    // Changes exactly when the percentiles may
+    long long getRevision() { return revision; }
+};
+
+#endif
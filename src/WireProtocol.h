@@ -0,0 +1,139 @@
+#ifndef WIREPROTOCOL_H
+#define WIREPROTOCOL_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Binary wire protocol for the socket server (optional, per connection).
+//
+// Handshake: a text-mode client sends the line "BINARY"; the server answers
+// "SUCCESS_BINARY <version>\n" and every byte after that, in both directions,
+// is binary frames:
+//
+//   WireHeader (12 bytes), then 'length' payload bytes
+//
+// All fields are little-endian and fixed-size. Strings are length-prefixed
+// (they may contain spaces) and are read in place from the receive buffer.
+// Responses echo the request's opcode and tag, so pipelined requests can be
+// matched without waiting for each reply.
+
+const uint32_t WIRE_VERSION = 1;
+const uint32_t WIRE_MAX_PAYLOAD = 1 << 20;
+
+enum WireOpcode {
+    WIRE_PING = 1,      // -> empty
+    WIRE_LOGIN = 2,     // WireLogin + user + password                   -> empty
+    WIRE_ADD = 3,       // WireAdd + name + description                  -> int64 id
+    WIRE_EXTRACT = 4,   // empty                                         -> WirePatient + strings
+    WIRE_PEEK = 5,      // empty                                         -> WirePatient + strings
+    WIRE_UPDATE = 6,    // WireUpdate                                    -> empty
+    WIRE_LEAVE = 7,     // int64 id                                      -> empty
+    WIRE_STATS = 8,     // empty                                         -> WireStats
+    WIRE_TOPK = 9,      // int32 k                                       -> uint32 n, n x (WirePatient + strings)
+    WIRE_TEXT = 10,     // Any text-protocol command line(s)             -> the text reply
+    WIRE_EXIT = 11      // empty (closes the connection after the reply) -> empty
+};
+
+enum WireStatus {
+    WIRE_OK = 0,
+    WIRE_EMPTY = 1,         // EXTRACT / PEEK on an empty queue
+    WIRE_NOT_FOUND = 2,     // Unknown patient ID
+    WIRE_BAD_REQUEST = 3,   // Unknown opcode, short payload, value out of range,
+                            // or an empty / control-byte name or description
+    WIRE_AUTH = 4,          // Log in first
+    WIRE_LOGIN_FAILED = 5,
+    WIRE_LOG_FAILED = 6     // Applied, but the write-ahead log could not be written (disk full?)
+};
+
+#pragma pack(push, 1)
+struct WireHeader {
+    uint32_t length;    // Payload bytes after this header
+    uint16_t opcode;    // WireOpcode
+    uint16_t status;    // WireStatus (responses; 0 in requests)
+    uint32_t tag;       // Chosen by the client, echoed in the response
+};
+
+struct WireLogin {
+    uint16_t userLen;
+    uint16_t passLen;
+};
+
+struct WireAdd {
+    int32_t priority;
+    int32_t age;
+    uint16_t nameLen;
+    uint16_t descLen;
+};
+
+struct WireUpdate {
+    int64_t id;
+    int32_t priority;
+};
+
+struct WirePatient {
+    int64_t id;
+    int64_t arrival;    // Microseconds since the epoch
+    int32_t priority;
+    int32_t age;
+    uint16_t nameLen;
+    uint16_t descLen;
+};
+
+struct WireStats {
+    int32_t count;                  // Patients waiting
+    int32_t levels;                 // Entries in the arrays below (index 0 = all levels)
+    int64_t treated[11];
+    int32_t p50[11];                // Observed waits in minutes, -1 = no data
+    int32_t p90[11];
+    int32_t p99[11];
+};
+#pragma pack(pop)
+
+// Bounds-checked, copy-free view of one frame's payload
+class WireReader {
+private:
+    const char* data;
+    size_t size;
+    size_t pos;
+
+public:
+    WireReader(const char* _data, size_t _size) : data(_data), size(_size), pos(0) {}
+
+    // Fixed-layout struct (memcpy: the buffer has no alignment guarantee)
+    template <typename T>
+    bool read(T& out) {
+        if (size - pos < sizeof(T)) return false;
+        memcpy(&out, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    // Pointer into the receive buffer; valid while the frame is being handled
+    bool bytes(size_t n, const char*& out) {
+        if (size - pos < n) return false;
+        out = data + pos;
+        pos += n;
+        return true;
+    }
+};
+
+// Appends a response frame to 'out'. The header's length is patched by endFrame().
+inline size_t beginFrame(std::string& out, uint16_t opcode, uint16_t status, uint32_t tag) {
+    size_t start = out.size();
+    WireHeader header = { 0, opcode, status, tag };
+    out.append((const char*)&header, sizeof(header));
+    return start;
+}
+
+inline void endFrame(std::string& out, size_t start) {
+    uint32_t length = (uint32_t)(out.size() - start - sizeof(WireHeader));
+    memcpy(&out[start], &length, sizeof(length));
+}
+
+template <typename T>
+inline void appendStruct(std::string& out, const T& value) {
+    out.append((const char*)&value, sizeof(T));
+}
+
+#endif
@@ -0,0 +1,376 @@
+#include "WriteAheadLog.h"
+#include "MappedFile.h"
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#define WAL_FSYNC(f) _commit(_fileno(f))
+#else
+#include <unistd.h>
+#define WAL_FSYNC(f) fsync(fileno(f))
+#endif
+
+// ==========================================
+// WRITE-AHEAD LOG IMPLEMENTATION
+// ==========================================
+
+// Frame header: payload length (4) + type (1) + checksum (4)
+static const size_t FRAME_HEADER = 9;
+
+WriteAheadLog::WriteAheadLog() {
+    file = nullptr;
+    pendingRecords = 0;
+    unsyncedRecords = 0;
+    fileBytes = 0;
+    lastSync = std::chrono::steady_clock::now();
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    if (file != nullptr) {
+        flush();
+        fclose(file);
+    }
+}
+
+uint32_t WriteAheadLog::checksum(const char* data, size_t n) {
+    // FNV-1a: cheap, and good enough to spot a torn tail
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool WriteAheadLog::open(std::string walFilename) {
+    filename = walFilename;
+    file = fopen(filename.c_str(), "ab");
+    if (file == nullptr) return false;
+
+    fseek(file, 0, SEEK_END);
+    fileBytes = ftell(file);
+    return true;
+}
+
+// ------------------------------------------
+// Record encoding
+// ------------------------------------------
+
+void WriteAheadLog::putBytes(const void* data, size_t n) {
+    pending.append((const char*)data, n);
+}
+
+void WriteAheadLog::beginRecord(WalRecordType type, size_t& start) {
+    start = pending.size();
+
+    // Placeholder header, patched in endRecord() once the payload is known
+    char header[FRAME_HEADER];
+    memset(header, 0, FRAME_HEADER);
+    header[4] = (char)type;
+    putBytes(header, FRAME_HEADER);
+}
+
+void WriteAheadLog::endRecord(size_t start) {
+    uint32_t payloadLen = (uint32_t)(pending.size() - start - FRAME_HEADER);
+    // The checksum covers the type byte and the payload
+    uint32_t sum = checksum(&pending[start + 4], 1);
+    sum ^= checksum(pending.data() + start + FRAME_HEADER, payloadLen);
+
+    memcpy(&pending[start], &payloadLen, 4);
+    memcpy(&pending[start + 5], &sum, 4);
+    pendingRecords++;
+}
+
+void WriteAheadLog::putPatient(long long id, int priority, int age, const std::string& name, const std::string& desc) {
+    // Same fixed layout as the version 1 snapshot records
+    SnapshotRecordV1 rec;
+    rec.id = id;
+    rec.priority = priority;
+    rec.age = age;
+    rec.nameLen = (uint32_t)name.size();
+    rec.descLen = (uint32_t)desc.size();
+    putBytes(&rec, sizeof(rec));
+    putBytes(name.data(), name.size());
+    putBytes(desc.data(), desc.size());
+}
+
+void WriteAheadLog::putArrival(long long arrival) {
+    int64_t arrival64 = arrival;
+    putBytes(&arrival64, 8);
+}
+
+void WriteAheadLog::logAdd(long long id, int priority, int age, const std::string& name, const std::string& desc,
+                           long long arrival) {
+    size_t start;
+    beginRecord(WAL_ADD_AT, start);
+    putPatient(id, priority, age, name, desc);
+    putArrival(arrival);
+    endRecord(start);
+}
+
+void WriteAheadLog::logUpdate(long long id, int priority) {
+    size_t start;
+    beginRecord(WAL_UPDATE, start);
+    int64_t id64 = id;
+    int32_t prio32 = priority;
+    putBytes(&id64, 8);
+    putBytes(&prio32, 4);
+    endRecord(start);
+}
+
+void WriteAheadLog::logLeave(long long id) {
+    size_t start;
+    beginRecord(WAL_LEAVE, start);
+    int64_t id64 = id;
+    putBytes(&id64, 8);
+    endRecord(start);
+}
+
+void WriteAheadLog::logExtract(long long id) {
+    size_t start;
+    beginRecord(WAL_EXTRACT, start);
+    int64_t id64 = id;
+    putBytes(&id64, 8);
+    endRecord(start);
+}
+
+void WriteAheadLog::logMerge(TriageQueue& incoming) {
+    size_t start;
+    beginRecord(WAL_MERGE_AT, start);
+    uint32_t count = (uint32_t)incoming.getNumNodes();
+    putBytes(&count, 4);
+    incoming.forEachPatient([this](const TriageEntry& entry) {
+        putPatient(entry.id, entry.priority, entry.record->age, entry.record->name, entry.record->description);
+        putArrival(entry.arrival);
+    });
+    endRecord(start);
+}
+
+void WriteAheadLog::logRestore(long long id, int priority, int age, const std::string& name,
+                               const std::string& desc, long long arrival) {
+    size_t start;
+    beginRecord(WAL_RESTORE, start);
+    putPatient(id, priority, age, name, desc);
+    putArrival(arrival);
+    endRecord(start);
+}
+
+void WriteAheadLog::logTransfer(long long id, const std::string& department) {
+    size_t start;
+    beginRecord(WAL_TRANSFER, start);
+    int64_t id64 = id;
+    putBytes(&id64, 8);
+    putBytes(department.data(), department.size());
+    endRecord(start);
+}
+
+size_t WriteAheadLog::getMark() {
+    return pending.size();
+}
+
+void WriteAheadLog::rollback(size_t mark) {
+    if (mark >= pending.size()) return;
+    pending.resize(mark);
+
+    // Rolled-back records never reach the disk; recount the frames left
+    pendingRecords = 0;
+    size_t pos = 0;
+    while (pos + FRAME_HEADER <= pending.size()) {
+        uint32_t payloadLen;
+        memcpy(&payloadLen, pending.data() + pos, 4);
+        pos += FRAME_HEADER + payloadLen;
+        pendingRecords++;
+    }
+}
+
+// ------------------------------------------
+// Group commit
+// ------------------------------------------
+
+bool WriteAheadLog::sync() {
+    if (fflush(file) != 0 || WAL_FSYNC(file) != 0) return false;
+    unsyncedRecords = 0;
+    lastSync = std::chrono::steady_clock::now();
+    return true;
+}
+
+void WriteAheadLog::truncateToCommitted() {
+    // Replay stops at the first torn record, so a partial write would hide
+    // every record appended after it. stdio can't drop what it still buffers:
+    // close the file, cut it back by name, and reopen it for appending.
+    fclose(file);
+#ifdef _WIN32
+    int fd = _open(filename.c_str(), _O_WRONLY | _O_BINARY);
+    if (fd >= 0) {
+        _chsize_s(fd, fileBytes);
+        _close(fd);
+    }
+#else
+    if (truncate(filename.c_str(), (off_t)fileBytes) != 0) {
+        // Nothing better to do: the torn tail is where replay stops
+    }
+#endif
+    file = fopen(filename.c_str(), "ab");
+}
+
+bool WriteAheadLog::commit() {
+    if (file == nullptr) return true; // No log (it could not be opened): nothing to report per command
+
+    if (!pending.empty()) {
+        // One write() for the whole command (or batch): survives a process crash
+        bool written = fwrite(pending.data(), 1, pending.size(), file) == pending.size();
+        written = (fflush(file) == 0) && written;
+        if (!written) {
+            truncateToCommitted();
+            return false;
+        }
+        fileBytes += (long)pending.size();
+        unsyncedRecords += pendingRecords;
+        pending.clear();
+        pendingRecords = 0;
+    }
+
+    // fsync only once per group: survives power loss with bounded delay
+    if (unsyncedRecords == 0) return true;
+    long long waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - lastSync).count();
+    if (unsyncedRecords >= GROUP_RECORDS || waited >= GROUP_MILLIS) {
+        return sync();
+    }
+    return true;
+}
+
+void WriteAheadLog::flush() {
+    if (file == nullptr) return;
+    if (commit() && unsyncedRecords > 0) sync();
+}
+
+bool WriteAheadLog::needsCompaction() {
+    return fileBytes >= COMPACT_BYTES;
+}
+
+bool WriteAheadLog::isEmpty() {
+    return fileBytes == 0 && pending.empty();
+}
+
+void WriteAheadLog::reset() {
+    if (file == nullptr) return;
+
+    // Reopen in "wb" mode to truncate, then go back to appending
+    fclose(file);
+    file = fopen(filename.c_str(), "wb");
+    if (file != nullptr) {
+        sync();
+        fclose(file);
+    }
+    file = fopen(filename.c_str(), "ab");
+
+    pending.clear();
+    pendingRecords = 0;
+    unsyncedRecords = 0;
+    fileBytes = 0;
+}
+
+// ------------------------------------------
+// Recovery
+// ------------------------------------------
+
+// Reads one patient payload; false if the buffer is too short
+static bool readPatient(const char*& p, const char* end, SnapshotRecordV1& rec,
+                        std::string& name, std::string& desc) {
+    if ((size_t)(end - p) < sizeof(rec)) return false;
+    memcpy(&rec, p, sizeof(rec));
+    p += sizeof(rec);
+
+    if ((size_t)(end - p) < (size_t)rec.nameLen + rec.descLen) return false;
+    name.assign(p, rec.nameLen);
+    p += rec.nameLen;
+    desc.assign(p, rec.descLen);
+    p += rec.descLen;
+    return true;
+}
+
+int WriteAheadLog::replay(DepartmentQueue& queue, long long& nextId) {
+    MappedFile log;
+    if (!log.open(filename) || log.size() == 0) return 0;
+
+    const char* p = log.data();
+    const char* end = p + log.size();
+    int applied = 0;
+
+    SnapshotRecordV1 rec;
+    std::string name, desc;
+
+    while ((size_t)(end - p) >= FRAME_HEADER) {
+        uint32_t payloadLen, storedSum;
+        memcpy(&payloadLen, p, 4);
+        char type = p[4];
+        memcpy(&storedSum, p + 5, 4);
+
+        // Torn tail: the last write did not make it completely
+        if ((size_t)(end - p - FRAME_HEADER) < payloadLen) break;
+
+        const char* payload = p + FRAME_HEADER;
+        const char* payloadEnd = payload + payloadLen;
+        uint32_t sum = checksum(p + 4, 1) ^ checksum(payload, payloadLen);
+        if (sum != storedSum) break;
+
+        const char* q = payload;
+        int64_t id64;
+        int32_t prio32;
+
+        switch (type) {
+            case WAL_ADD_AT:
+            case WAL_RESTORE:
+                if (readPatient(q, payloadEnd, rec, name, desc) && (size_t)(payloadEnd - q) >= 8) {
+                    int64_t arrival64;
+                    memcpy(&arrival64, q, 8);
+                    queue.insert(rec.id, rec.priority, rec.age, name, desc, arrival64);
+                    if (rec.id >= nextId) nextId = rec.id + 1;
+                }
+                break;
+            case WAL_UPDATE:
+                if (payloadLen >= 12) {
+                    memcpy(&id64, q, 8);
+                    memcpy(&prio32, q + 8, 4);
+                    queue.updatePriority(id64, prio32);
+                }
+                break;
+            case WAL_LEAVE:
+            case WAL_EXTRACT:
+                if (payloadLen >= 8) {
+                    memcpy(&id64, q, 8);
+                    queue.removePatient(id64);
+                }
+                break;
+            case WAL_TRANSFER:
+                if (payloadLen >= 8) {
+                    memcpy(&id64, q, 8);
+                    int department = queue.findDepartment(std::string(q + 8, payloadLen - 8));
+                    if (department >= 0) queue.transfer(id64, department);
+                }
+                break;
+            case WAL_MERGE_AT:
+                if (payloadLen >= 4) {
+                    uint32_t count;
+                    memcpy(&count, q, 4);
+                    q += 4;
+                    queue.reserve((int)count);
+                    for (uint32_t i = 0; i < count; i++) {
+                        int64_t arrival64;
+                        if (!readPatient(q, payloadEnd, rec, name, desc) || (size_t)(payloadEnd - q) < 8) break;
+                        memcpy(&arrival64, q, 8);
+                        q += 8;
+                        queue.insert(rec.id, rec.priority, rec.age, name, desc, arrival64);
+                        if (rec.id >= nextId) nextId = rec.id + 1;
+                    }
+                }
+                break;
+        }
+
+        applied++;
+        p = payloadEnd;
+    }
+    return applied;
+}
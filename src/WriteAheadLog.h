@@ -0,0 +1,105 @@
+#ifndef WRITEAHEADLOG_H
+#define WRITEAHEADLOG_H
+
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include "TriageQueue.h"
+#include "DepartmentQueue.h"
+#include "Snapshot.h"
+
+// Record types (one per mutating command)
+enum WalRecordType {
+    WAL_ADD_AT = 'a',   // id, priority, age, name, description + i64 arrival
+    WAL_UPDATE = 'U',   // id, priority
+    WAL_LEAVE = 'L',    // id
+    WAL_EXTRACT = 'X',  // id (replayed by ID, so ties can't change the outcome)
+    WAL_MERGE_AT = 'm', // count, then count (ADD payload + i64 arrival)
+    WAL_RESTORE = 'R',  // ADD payload + i64 arrival (UNDO / REDO: the patient keeps their place)
+    WAL_TRANSFER = 'T'  // id, department name bytes (by name: --queues may be reordered)
+};
+
+// Append-only write-ahead log (patients_data.wal)
+//
+// Each record is framed as { u32 payloadLen, u8 type, u32 checksum, payload }.
+// Records are buffered per command and written with one write() in commit();
+// fsync is batched (group commit) every GROUP_RECORDS records or GROUP_MILLIS ms.
+// Replay is idempotent on top of any snapshot taken after the log started,
+// so a crash between "snapshot written" and "log truncated" is harmless.
+// Admissions carry their arrival time, so replayed patients keep their place,
+// their aging deadlines and their measured waits.
+class WriteAheadLog {
+private:
+    static const int GROUP_RECORDS = 32;        // fsync after this many records...
+    static const int GROUP_MILLIS = 200;        // ...or after this much time
+    static const long COMPACT_BYTES = 4 << 20;  // Fold into the snapshot past 4 MB
+
+    std::string filename;
+    FILE* file;
+
+    std::string pending;    // Records of the current command (not yet written)
+    int pendingRecords;
+    int unsyncedRecords;    // Written but not yet fsync'ed
+    long fileBytes;
+    std::chrono::steady_clock::time_point lastSync;
+
+    // Non-copyable: owns the file handle
+    WriteAheadLog(const WriteAheadLog&);
+    WriteAheadLog& operator=(const WriteAheadLog&);
+
+    void beginRecord(WalRecordType type, size_t& start);
+    void endRecord(size_t start);
+    void putPatient(long long id, int priority, int age, const std::string& name, const std::string& desc);
+    void putArrival(long long arrival);
+    void putBytes(const void* data, size_t n);
+    bool sync();
+    void truncateToCommitted();
+
+    static uint32_t checksum(const char* data, size_t n);
+
+public:
+    WriteAheadLog();
+    ~WriteAheadLog();
+
+    // Opens (or creates) the log for appending
+    bool open(std::string walFilename);
+
+    // Re-applies every intact record to 'queue'. Stops at the first torn or
+    // corrupt record (a crash mid-write). Returns the number of records applied.
+    // Transfers to a department that is not configured (any more) are skipped.
+    int replay(DepartmentQueue& queue, long long& nextId);
+
+    // --- Logging (buffered until commit) ---
+    void logAdd(long long id, int priority, int age, const std::string& name, const std::string& desc,
+                long long arrival);
+    void logUpdate(long long id, int priority);
+    void logLeave(long long id);
+    void logExtract(long long id);
+    void logMerge(TriageQueue& incoming);
+    void logRestore(long long id, int priority, int age, const std::string& name, const std::string& desc,
+                    long long arrival);
+    void logTransfer(long long id, const std::string& department);
+
+    // Undo records logged after 'mark' (a value from getMark()) that were not committed yet
+    size_t getMark();
+    void rollback(size_t mark);
+
+    // Writes the buffered records; fsyncs when the group is full or old enough.
+    // false = the write or the fsync failed (disk full, I/O error): the file is
+    // cut back to the last complete commit and the records stay buffered, so
+    // the next commit() tries them again.
+    bool commit();
+
+    // Forces everything to disk (used on EXIT)
+    void flush();
+
+    // True once the log is big enough to be folded into the snapshot
+    bool needsCompaction();
+    bool isEmpty();
+
+    // Empties the log (call only after a snapshot with all changes was saved)
+    void reset();
+};
+
+#endif
@@ -1,7 +1,31 @@
 #include "System.h"
+#include <cstdlib>
+#include <cstring>
+#include <string>
 
-int main() {
-    System app;
+int main(int argc, char* argv[]) {
+    // Usage: triage [--engine=fib|fib-age|bucket] [--aging-scale=N] [--listen=ADDRESS] [--auth-cost=N]
+    //               [--queues=NAME,NAME,...]
+    // ADDRESS: <port> (localhost), <host>:<port>, or unix:<path>
+    // N for --auth-cost: PBKDF2 iterations per stored password (bench/AuthBench.cpp)
+    // --queues: department queues next to "main", e.g. --queues=trauma,peds,fast-track
+    std::string engine = "fib";
+    std::string listenAddress;
+    int agingScale = 1;
+    int authCost = DEFAULT_KDF_ITERATIONS;
+    std::string queues;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--engine=", 9) == 0) engine = argv[i] + 9;
+        if (strncmp(argv[i], "--aging-scale=", 14) == 0) agingScale = atoi(argv[i] + 14);
+        if (strncmp(argv[i], "--listen=", 9) == 0) listenAddress = argv[i] + 9;
+        if (strncmp(argv[i], "--auth-cost=", 12) == 0) authCost = atoi(argv[i] + 12);
+        if (strncmp(argv[i], "--queues=", 9) == 0) queues = argv[i] + 9;
+    }
+
+    System app(engine, agingScale, authCost, queues);
+    if (!listenAddress.empty()) {
+        return app.serve(listenAddress) ? 0 : 1;
+    }
     app.run();
     return 0;
-}
\ No newline at end of file
+}